@@ -74,6 +74,10 @@ public:
   void
   setNodeStyle(NodeStyle const& style);
 
+  /// The style is shared, not copied: use it for styles applied to many nodes
+  void
+  setNodeStyle(std::shared_ptr<const NodeStyle> style);
+
 public:
 
   /// Triggers the algorithm
@@ -123,6 +127,6 @@ signals:
 
 private:
 
-  NodeStyle _nodeStyle;
+  std::shared_ptr<const NodeStyle> _nodeStyle;
 };
 }
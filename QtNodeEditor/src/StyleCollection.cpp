@@ -9,7 +9,7 @@ NodeStyle const&
 StyleCollection::
 nodeStyle()
 {
-  return instance()._nodeStyle;
+  return *instance()._nodeStyle;
 }
 
 
@@ -17,7 +17,7 @@ ConnectionStyle const&
 StyleCollection::
 connectionStyle()
 {
-  return instance()._connectionStyle;
+  return *instance()._connectionStyle;
 }
 
 
@@ -29,11 +29,27 @@ flowViewStyle()
 }
 
 
+std::shared_ptr<const NodeStyle>
+StyleCollection::
+sharedNodeStyle()
+{
+  return instance()._nodeStyle;
+}
+
+
+std::shared_ptr<const ConnectionStyle>
+StyleCollection::
+sharedConnectionStyle()
+{
+  return instance()._connectionStyle;
+}
+
+
 void
 StyleCollection::
 setNodeStyle(NodeStyle nodeStyle)
 {
-  instance()._nodeStyle = nodeStyle;
+  instance()._nodeStyle = std::make_shared<const NodeStyle>(std::move(nodeStyle));
 }
 
 
@@ -41,7 +57,7 @@ void
 StyleCollection::
 setConnectionStyle(ConnectionStyle connectionStyle)
 {
-  instance()._connectionStyle = connectionStyle;
+  instance()._connectionStyle = std::make_shared<const ConnectionStyle>(std::move(connectionStyle));
 }
 
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "NodeStyle.hpp"
 #include "ConnectionStyle.hpp"
 #include "FlowViewStyle.hpp"
@@ -23,6 +25,15 @@ public:
   FlowViewStyle const&
   flowViewStyle();
 
+  /// Same as nodeStyle(), shared by all the models that don't set their own
+  static
+  std::shared_ptr<const NodeStyle>
+  sharedNodeStyle();
+
+  static
+  std::shared_ptr<const ConnectionStyle>
+  sharedConnectionStyle();
+
 public:
 
   static
@@ -52,9 +63,9 @@ private:
 
 private:
 
-  NodeStyle _nodeStyle;
+  std::shared_ptr<const NodeStyle> _nodeStyle = std::make_shared<const NodeStyle>();
 
-  ConnectionStyle _connectionStyle;
+  std::shared_ptr<const ConnectionStyle> _connectionStyle = std::make_shared<const ConnectionStyle>();
 
   FlowViewStyle _flowViewStyle;
 };
@@ -94,7 +94,8 @@ NodeModels ReadTreeNodesModel(const QDomElement &root)
              node = node.nextSiblingElement() )
         {
             auto model = buildTreeNodeModelFromXML(node);
-            models.insert( {model.registration_ID, model} );
+            const QString ID = model.registration_ID;
+            models.insert( {ID, MakeNodeModel( std::move(model) )} );
         }
     }
 
@@ -106,7 +107,8 @@ NodeModels ReadTreeNodesModel(const QDomElement &root)
             model.registration_ID.isEmpty() == false &&
             models.count(model.registration_ID) == 0)
         {
-            models.insert( {model.registration_ID, model} );
+            const QString ID = model.registration_ID;
+            models.insert( {ID, MakeNodeModel( std::move(model) )} );
         }
 
         for( QDomElement child = node.firstChildElement();
@@ -1,6 +1,8 @@
 #include "bt_editor_base.h"
 #include <behaviortree_cpp_v3/decorators/subtree_node.h>
 #include <QDebug>
+#include <QSet>
+#include <mutex>
 
 void AbsBehaviorTree::clear()
 {
@@ -87,7 +89,7 @@ void AbsBehaviorTree::debugPrint() const
 
         printf("%s (%s)",
                node->instance_name.toStdString().c_str(),
-               node->model.registration_ID.toStdString().c_str() );
+               node->model->registration_ID.toStdString().c_str() );
         std::cout << std::endl; // force flush
 
         for(int index: node->children_index)
@@ -101,6 +103,114 @@ void AbsBehaviorTree::debugPrint() const
 
 }
 
+namespace {
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+inline void HashBytes(uint64_t& hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+}
+
+template <typename T>
+inline void HashScalar(uint64_t& hash, T value)
+{
+    HashBytes( hash, &value, sizeof(T) );
+}
+
+inline void HashString(uint64_t& hash, const QString& str)
+{
+    HashScalar( hash, str.size() );
+    HashBytes( hash, str.constData(), sizeof(QChar) * size_t( str.size() ) );
+}
+
+}
+
+uint64_t ContentHash(const QByteArray &data)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    HashBytes( hash, data.constData(), size_t( data.size() ) );
+    return hash;
+}
+
+uint64_t AbsBehaviorTree::structuralHash(size_t index) const
+{
+    // bottom-up, computed every time: the nodes can be modified through pointers
+    std::function<uint64_t(size_t)> hashStep;
+    hashStep = [&](size_t node_index) -> uint64_t
+    {
+        const AbstractTreeNode& node = _nodes.at(node_index);
+        uint64_t hash = FNV_OFFSET_BASIS;
+        HashString( hash, node.model->registration_ID );
+        HashString( hash, node.instance_name );
+
+        HashScalar( hash, node.ports_mapping.size() );
+        for (const auto& port_it: node.ports_mapping)
+        {
+            HashString( hash, port_it.first );
+            HashString( hash, port_it.second );
+        }
+
+        HashScalar( hash, node.children_index.size() );
+        for (int child_index: node.children_index)
+        {
+            HashScalar( hash, hashStep( child_index ) );
+        }
+        return hash;
+    };
+    return hashStep( index );
+}
+
+uint64_t AbsBehaviorTree::structuralHash() const
+{
+    return _nodes.empty() ? 0 : structuralHash(0);
+}
+
+bool AbsBehaviorTree::sameStructure(const AbsBehaviorTree &other) const
+{
+    if( _nodes.size() != other._nodes.size() )
+    {
+        return false;
+    }
+    if( _nodes.empty() )
+    {
+        return true;
+    }
+    // fast reject only: equal hashes might be a collision
+    if( structuralHash() != other.structuralHash() )
+    {
+        return false;
+    }
+
+    std::function<bool(int,int)> sameSubtree;
+    sameSubtree = [&](int index, int other_index) -> bool
+    {
+        const AbstractTreeNode& node = _nodes[index];
+        const AbstractTreeNode& other_node = other._nodes[other_index];
+        if( node.model->registration_ID != other_node.model->registration_ID ||
+            node.instance_name != other_node.instance_name ||
+            node.ports_mapping != other_node.ports_mapping ||
+            node.children_index.size() != other_node.children_index.size() )
+        {
+            return false;
+        }
+        for (size_t i = 0; i < node.children_index.size(); i++)
+        {
+            if( !sameSubtree( node.children_index[i], other_node.children_index[i] ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    return sameSubtree( 0, 0 );
+}
+
 bool AbsBehaviorTree::operator ==(const AbsBehaviorTree &other) const
 {
     if( _nodes.size() != other._nodes.size() ) return false;
@@ -134,7 +244,7 @@ const char *toStr(GraphicMode type)
 
 bool AbstractTreeNode::operator ==(const AbstractTreeNode &other) const
 {
-    bool same_registration = model.registration_ID == other.model.registration_ID;
+    bool same_registration = model->registration_ID == other.model->registration_ID;
     return  same_registration &&
             status == other.status &&
             size == other.size &&
@@ -169,6 +279,48 @@ bool NodeModel::operator ==(const NodeModel &other) const
     return true;
 }
 
+QString InternString(const QString &str)
+{
+    // the trees are built also by the threads of the monitor.
+    // Never freed: only names are interned, see MakeNodeModel()
+    static std::mutex mutex;
+    static QSet<QString> strings;
+
+    std::lock_guard<std::mutex> lock( mutex );
+    auto it = strings.constFind( str );
+    if( it == strings.constEnd() )
+    {
+        it = strings.insert( str );
+    }
+    return *it;
+}
+
+NodeModelPtr MakeNodeModel(NodeModel model)
+{
+    model.registration_ID = InternString( model.registration_ID );
+
+    PortModels ports;
+    for (auto& port_it: model.ports)
+    {
+        PortModel& port = port_it.second;
+        port.type_name = InternString( port.type_name );
+        ports.insert( { InternString( port_it.first ), std::move(port) } );
+    }
+    model.ports = std::move(ports);
+    return std::make_shared<const NodeModel>( std::move(model) );
+}
+
+const NodeModelPtr& UndefinedNodeModel()
+{
+    static const NodeModelPtr undefined = []()
+    {
+        NodeModel model;
+        model.type = NodeType::UNDEFINED;
+        return MakeNodeModel( std::move(model) );
+    }();
+    return undefined;
+}
+
 NodeModel &NodeModel::operator =(const BT::TreeNodeManifest &src)
 {
     this->type = src.type;
@@ -205,7 +357,7 @@ const NodeModels &BuiltinNodeModels()
             const auto& bt_model = it.second;
             NodeModel groot_model;
             groot_model = bt_model;
-            out.insert( { QString::fromStdString(model_name), std::move(groot_model) });
+            out.insert( { QString::fromStdString(model_name), MakeNodeModel( std::move(groot_model) ) });
         }
         return out;
      }();
@@ -5,6 +5,7 @@
 #include <QPointF>
 #include <QSizeF>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <nodes/Node>
 #include <deque>
@@ -46,7 +47,26 @@ struct  NodeModel
     NodeModel& operator = (const BT::TreeNodeManifest& src);
 };
 
-typedef std::map<QString, NodeModel> NodeModels;
+// Models are immutable and shared by the registry, the scene and the trees:
+// copying a NodeModelPtr, or an AbsBehaviorTree, doesn't copy the ports.
+typedef std::shared_ptr<const NodeModel> NodeModelPtr;
+
+typedef std::map<QString, NodeModelPtr> NodeModels;
+
+// Returns a string with the same content that shares the buffer of the
+// previous ones: IDs and port names repeated in thousands of nodes are stored once.
+// The strings are never released: intern only names from a small set.
+QString InternString(const QString& str);
+
+// The registration ID, the port names and the port types are interned;
+// descriptions and default values are not.
+NodeModelPtr MakeNodeModel(NodeModel model);
+
+// type UNDEFINED, without ID and ports
+const NodeModelPtr& UndefinedNodeModel();
+
+// FNV-1a hash of the bytes, to compare snapshots without comparing their content
+uint64_t ContentHash(const QByteArray& data);
 
 
 enum class GraphicMode { EDITOR, MONITOR, REPLAY };
@@ -61,14 +81,13 @@ const NodeModels& BuiltinNodeModels();
 struct AbstractTreeNode
 {
     AbstractTreeNode() :
+        model(UndefinedNodeModel()),
         index(-1),
         status(NodeStatus::IDLE),
         graphic_node(nullptr)
-    {
-        model.type = NodeType::UNDEFINED;
-    }
+    {}
 
-    NodeModel model;
+    NodeModelPtr model;
     PortsMapping ports_mapping;
     int index;
     QString instance_name;
@@ -120,6 +139,21 @@ public:
 
     void debugPrint() const;
 
+    // Hash of the subtree with root in the node at this index: registration ID,
+    // instance name and port mapping of its nodes, children in order.
+    // Equal subtrees have the same hash, wherever they are, in any tree.
+    // Not cached: O(size of the subtree).
+    uint64_t structuralHash(size_t index) const;
+
+    // hash of the root; 0 if the tree is empty
+    uint64_t structuralHash() const;
+
+    // Same structure: registration ID, instance name, port mapping and children
+    // of the nodes, from the root; status, position and size are ignored.
+    // Different hashes of the roots are a fast reject.
+    bool sameStructure(const AbsBehaviorTree &other) const;
+
+    // same nodes at the same indexes: ID, instance name, status and size
     bool operator ==(const AbsBehaviorTree &other) const;
 
     bool operator !=(const AbsBehaviorTree &other) const{
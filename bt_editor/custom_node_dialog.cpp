@@ -39,7 +39,7 @@ CustomNodeDialog::CustomNodeDialog(const NodeModels &models,
             ui->lineEdit->setText( to_edit );
 
             const auto& model = model_it->second;
-            for( const auto& port_it : model.ports )
+            for( const auto& port_it : model->ports )
             {
                 int row = ui->tableWidget->rowCount();
                 ui->tableWidget->setRowCount(row+1);
@@ -61,24 +61,24 @@ CustomNodeDialog::CustomNodeDialog(const NodeModels &models,
                 ui->tableWidget->setItem(row,3, new QTableWidgetItem(port_it.second.description) );
             }
 
-            if( model.type == NodeType::ACTION )
+            if( model->type == NodeType::ACTION )
             {
                 ui->comboBox->setCurrentIndex(0);
             }
-            else if( model.type == NodeType::CONDITION )
+            else if( model->type == NodeType::CONDITION )
             {
                 ui->comboBox->setCurrentIndex(1);
             }
-            else if( model.type == NodeType::CONTROL )
+            else if( model->type == NodeType::CONTROL )
             {
               ui->comboBox->setCurrentIndex(2);
             }
-            else if( model.type == NodeType::SUBTREE )
+            else if( model->type == NodeType::SUBTREE )
             {
                 ui->comboBox->setCurrentIndex(3);
                 ui->comboBox->setEnabled(false);
             }
-            else if( model.type == NodeType::DECORATOR)
+            else if( model->type == NodeType::DECORATOR)
             {
                 ui->comboBox->setCurrentIndex(4);
             }
@@ -100,7 +100,7 @@ CustomNodeDialog::~CustomNodeDialog()
 }
 
 
-NodeModel CustomNodeDialog::getTreeNodeModel() const
+NodeModelPtr CustomNodeDialog::getTreeNodeModel() const
 {
     QString ID = ui->lineEdit->text();
     NodeType type = NodeType::UNDEFINED;
@@ -129,7 +129,7 @@ NodeModel CustomNodeDialog::getTreeNodeModel() const
         port_model.description   =  ui->tableWidget->item(row,3)->text();
         ports.insert( {key, port_model} );
     }
-    return { type, ID, ports };
+    return MakeNodeModel( { type, ID, ports } );
 }
 
 
@@ -19,7 +19,7 @@ public:
 
     ~CustomNodeDialog() override;
 
-    NodeModel getTreeNodeModel() const;
+    NodeModelPtr getTreeNodeModel() const;
 
 private slots:
     void on_pushButtonAdd_pressed();
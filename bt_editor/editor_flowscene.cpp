@@ -74,7 +74,7 @@ void EditorFlowScene::keyPressEvent(QKeyEvent *event)
         }
     }
 
-    const QString& registration_ID = _clipboard_node.model.registration_ID;
+    const QString registration_ID = _clipboard_node.model->registration_ID;
 
     auto selected_items = selectedItems();
     if( selected_items.size() == 1 &&
@@ -11,6 +11,8 @@
 #include <QMessageBox>
 #include <QApplication>
 #include <QInputDialog>
+#include <QTimer>
+#include <limits>
 
 using namespace QtNodes;
 
@@ -18,7 +20,13 @@ GraphicContainer::GraphicContainer(std::shared_ptr<DataModelRegistry> model_regi
                                    QWidget *parent) :
     QObject(parent),
     _model_registry( std::move(model_registry) ),
-    _signal_was_blocked(true)
+    _signal_was_blocked(true),
+    _tree_valid(false),
+    _overlay_geometry_valid(false),
+    _overlay_refresh_scheduled(false),
+    _visible_rect_valid(false),
+    _flush_scheduled(false),
+    _selection_update_scheduled(false)
 {
     _scene = new EditorFlowScene( _model_registry, parent );
     _view  = new QtNodes::FlowView( _scene, parent );
@@ -38,6 +46,9 @@ GraphicContainer::GraphicContainer(std::shared_ptr<DataModelRegistry> model_regi
     connect( _scene, &QtNodes::FlowScene::nodeDeleted,
              this,   &GraphicContainer::undoableChange  );
 
+    connect( _scene, &QtNodes::FlowScene::nodeMoved,
+             this,   &GraphicContainer::onNodeMoved  );
+
     connect( _scene, &QtNodes::FlowScene::nodeMoved,
              this,   &GraphicContainer::undoableChange  );
 
@@ -67,6 +78,23 @@ GraphicContainer::GraphicContainer(std::shared_ptr<DataModelRegistry> model_regi
         }
     });
 
+    connect( _scene, &QtNodes::FlowScene::nodeCreated,
+             this, &GraphicContainer::invalidateTree );
+
+    connect( _scene, &QtNodes::FlowScene::nodeDeleted,
+             this, &GraphicContainer::invalidateTree );
+
+    connect( _scene, &QtNodes::FlowScene::connectionCreated,
+             this, &GraphicContainer::invalidateTree );
+
+    connect( _scene, &QtNodes::FlowScene::connectionDeleted,
+             this, &GraphicContainer::invalidateTree );
+
+    _status_overlay = new StatusOverlayItem();
+    _scene->addItem( _status_overlay );
+
+    // scroll, zoom, resize and tab changes are followed by a paint of the viewport
+    _view->viewport()->installEventFilter( this );
 }
 
 void GraphicContainer::lockEditing(bool locked)
@@ -114,6 +142,11 @@ void GraphicContainer::lockEditing(bool locked)
         QtNodes::Connection* conn = conn_it.second.get();
         conn->connectionGraphicsObject().lock( locked );
     }
+
+    if( !locked )
+    {
+        _status_overlay->clearStyles();
+    }
 }
 
 void GraphicContainer::lockSubtreeEditing(Node &root_node, bool locked, bool change_style)
@@ -156,13 +189,26 @@ void GraphicContainer::nodeReorder()
 {
     {
         const QSignalBlocker blocker(this);
-        auto abstract_tree = BuildTreeFromScene( _scene );
+        auto abstract_tree = tree();
         NodeReorder( *_scene, abstract_tree );
+        // setNodePosition doesn't emit nodeMoved. The order of the children is the same
+        _tree = std::move( abstract_tree );
+        invalidateNodesGeometry();
         zoomHomeView();
     }
     emit undoableChange();
 }
 
+void GraphicContainer::setLayout(PortLayout layout)
+{
+    // the children are ordered like in the previous layout
+    auto abstract_tree = tree();
+    _scene->setLayout( layout );
+    NodeReorder( *_scene, abstract_tree );
+    _tree = std::move( abstract_tree );
+    invalidateNodesGeometry();
+}
+
 void GraphicContainer::zoomHomeView()
 {
     QRectF rect = _scene->itemsBoundingRect();
@@ -229,6 +275,156 @@ void GraphicContainer::clearScene()
 {
     const QSignalBlocker blocker( this );
     _scene->clearScene();
+    _tree_valid = false;
+    _overlay_geometry_valid = false;
+    _status_overlay->setNodes( {} );
+}
+
+const AbsBehaviorTree& GraphicContainer::tree()
+{
+    if( _selection_update_scheduled )
+    {
+        updateSelectedNodes();
+    }
+    if( !_tree_valid )
+    {
+        _tree = BuildTreeFromScene( _scene );
+
+        const auto& nodes = static_cast<const AbsBehaviorTree&>(_tree).nodes();
+        _nodes_by_index.resize( nodes.size() );
+        _parent_index.assign( nodes.size(), -1 );
+        _index_by_node.clear();
+        for (size_t index = 0; index < nodes.size(); index++)
+        {
+            _nodes_by_index[index] = nodes[index].graphic_node;
+            _index_by_node[ nodes[index].graphic_node ] = static_cast<int>(index);
+            for (int child_index: nodes[index].children_index)
+            {
+                _parent_index[child_index] = static_cast<int>(index);
+            }
+        }
+        _tree_valid = true;
+    }
+    return _tree;
+}
+
+const std::vector<QtNodes::Node*>& GraphicContainer::nodesByIndex()
+{
+    tree();
+    return _nodes_by_index;
+}
+
+StatusOverlayItem* GraphicContainer::statusOverlay()
+{
+    if( !_overlay_geometry_valid )
+    {
+        _status_overlay->setNodes( nodesByIndex() );
+        _overlay_geometry_valid = true;
+    }
+    _status_overlay->setVisibleRect( visibleSceneRect() );
+    return _status_overlay;
+}
+
+QRectF GraphicContainer::visibleSceneRect()
+{
+    if( !_visible_rect_valid )
+    {
+        _visible_rect = QRectF();
+        if( _view->isVisible() )
+        {
+            _visible_rect = _view->mapToScene( _view->viewport()->rect() ).boundingRect();
+        }
+        _visible_rect_valid = true;
+    }
+    return _visible_rect;
+}
+
+bool GraphicContainer::eventFilter(QObject* obj, QEvent* event)
+{
+    if( obj == _view->viewport() && event->type() == QEvent::Paint )
+    {
+        _visible_rect_valid = false;
+        if( _status_overlay->pendingCount() > 0 && !_flush_scheduled )
+        {
+            // the overlay is not updated while painting
+            _flush_scheduled = true;
+            QTimer::singleShot( 0, this, [this]()
+            {
+                _flush_scheduled = false;
+                _status_overlay->setVisibleRect( visibleSceneRect() );
+            });
+        }
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void GraphicContainer::invalidateTree()
+{
+    _tree_valid = false;
+    invalidateNodesGeometry();
+}
+
+void GraphicContainer::updateTreeNode(Node &node)
+{
+    invalidateNodesGeometry();
+    if( !_tree_valid )
+    {
+        return;
+    }
+    auto it = _index_by_node.find( &node );
+    auto bt_model = dynamic_cast<BehaviorTreeDataModel*>( node.nodeDataModel() );
+    if( it == _index_by_node.end() || !bt_model )
+    {
+        // not connected to the root
+        return;
+    }
+    const int index = it->second;
+
+    AbstractTreeNode* abs_node = _tree.node( index );
+    abs_node->instance_name = bt_model->instanceName();
+    abs_node->ports_mapping = bt_model->getCurrentPortMapping();
+    abs_node->pos  = _scene->getNodePosition( node );
+    abs_node->size = _scene->getNodeSize( node );
+
+    const int parent_index = _parent_index[index];
+    if( parent_index < 0 )
+    {
+        return;
+    }
+    // same order of getChildren(): the center of the siblings, left to right
+    // or top to bottom
+    const auto& nodes = static_cast<const AbsBehaviorTree&>(_tree).nodes();
+    const bool vertical = ( _scene->layout() == PortLayout::Vertical );
+    double prev_pos = std::numeric_limits<double>::lowest();
+    for (int sibling_index: nodes[parent_index].children_index)
+    {
+        const auto& sibling = nodes[sibling_index];
+        const double pos = vertical ? sibling.pos.x() + sibling.size.width()*0.5 :
+                                      sibling.pos.y() + sibling.size.height()*0.5;
+        if( pos < prev_pos )
+        {
+            _tree_valid = false;
+            return;
+        }
+        prev_pos = pos;
+    }
+}
+
+void GraphicContainer::invalidateNodesGeometry()
+{
+    _overlay_geometry_valid = false;
+
+    // the outlines shown must follow the nodes, but the scene might be in the
+    // middle of a change (e.g. nodeDeleted is emitted before the removal)
+    if( _status_overlay->outlinesCount() > 0 && !_overlay_refresh_scheduled )
+    {
+        _overlay_refresh_scheduled = true;
+        QTimer::singleShot( 0, this, [this]()
+        {
+            _overlay_refresh_scheduled = false;
+            statusOverlay();
+        });
+    }
 }
 
 
@@ -278,7 +474,7 @@ void GraphicContainer::createSubtree(Node &root_node, QString subtree_name )
         return;
     }
 
-    addNewModel( { NodeType::SUBTREE, subtree_name, {}} );
+    addNewModel( MakeNodeModel( { NodeType::SUBTREE, subtree_name, {}} ) );
     QApplication::processEvents();
 
     auto sub_tree = BuildTreeFromScene(_scene, &root_node);
@@ -322,6 +518,13 @@ void GraphicContainer::onNodeCreated(Node &node)
 {
     if( auto bt_node = dynamic_cast<BehaviorTreeDataModel*>( node.nodeDataModel() ) )
     {
+        // before undoableChange: the tree must be updated first.
+        // The sender is destroyed together with the node
+        auto updateNode = [this, &node]() { updateTreeNode( node ); };
+        connect( bt_node, &BehaviorTreeDataModel::parameterUpdated, this, updateNode );
+        connect( bt_node, &BehaviorTreeDataModel::instanceNameChanged, this, updateNode );
+        connect( bt_node, &BehaviorTreeDataModel::embeddedWidgetSizeUpdated, this, updateNode );
+
         connect( bt_node, &BehaviorTreeDataModel::parameterUpdated,
                  this, &GraphicContainer::undoableChange );
 
@@ -400,7 +603,7 @@ QtNodes::Node* GraphicContainer::substituteNode(Node *old_node, const QString& n
     {
         // if the old one contains an edited instance name, use it in new_node
         if( bt_old_node->instanceName() != bt_old_node->registrationName() &&
-            bt_new_node->model().type != NodeType::SUBTREE )
+            bt_new_node->model()->type != NodeType::SUBTREE )
         {
             bt_new_node->setInstanceName( bt_old_node->instanceName() );
         }
@@ -543,6 +746,35 @@ void GraphicContainer::onSmartRemove(QtNodes::Node* node)
     undoableChange();
 }
 
+void GraphicContainer::onNodeMoved(Node &node)
+{
+    updateTreeNode( node );
+
+    // the other selected nodes were dragged together with this one. Many of them
+    // might emit nodeMoved: update the whole selection once, after all of them
+    if( !_selection_update_scheduled && _scene->selectedNodes().size() > 1 )
+    {
+        _selection_update_scheduled = true;
+        QTimer::singleShot( 0, this, [this]()
+        {
+            // tree() might have done it already
+            if( _selection_update_scheduled )
+            {
+                updateSelectedNodes();
+            }
+        });
+    }
+}
+
+void GraphicContainer::updateSelectedNodes()
+{
+    _selection_update_scheduled = false;
+    for (auto selected_node: _scene->selectedNodes())
+    {
+        updateTreeNode( *selected_node );
+    }
+}
+
 void GraphicContainer::insertNodeInConnection(Connection &connection, QString node_name)
 {
     {
@@ -601,7 +833,7 @@ void GraphicContainer::recursiveLoadStep(QPointF& cursor,
                                          AbstractTreeNode* abs_node,
                                          Node* parent_node, int nest_level)
 {
-    Node& new_node = _scene->createNodeAtPos( abs_node->model.registration_ID,
+    Node& new_node = _scene->createNodeAtPos( abs_node->model->registration_ID,
                                               abs_node->instance_name,
                                               cursor);
     BehaviorTreeDataModel* bt_node = dynamic_cast<BehaviorTreeDataModel*>( new_node.nodeDataModel() );
@@ -619,7 +851,7 @@ void GraphicContainer::recursiveLoadStep(QPointF& cursor,
     abs_node->graphic_node = &new_node;
 
     // Special case for node Subtree. Expand if necessary
-    if( abs_node->model.type == NodeType::SUBTREE &&
+    if( abs_node->model->type == NodeType::SUBTREE &&
             abs_node->children_index.size() == 1 )
     {
         if( auto subtree_node = dynamic_cast<SubtreeNodeModel*>( bt_node ) )
@@ -658,7 +890,7 @@ void GraphicContainer::loadSceneFromTree(const AbsBehaviorTree &tree)
 
     auto root_node = abs_tree.rootNode();
 
-    if( root_node->model.registration_ID == "Root" )
+    if( root_node->model->registration_ID == "Root" )
     {
         root_node->graphic_node = &first_qt_node;
         int root_child_index = root_node->children_index.front();
@@ -683,7 +915,7 @@ void GraphicContainer::appendTreeToNode(Node &node, AbsBehaviorTree& subtree)
 
     auto root_node = subtree.rootNode();
 
-    if( root_node->model.registration_ID == "Root" )
+    if( root_node->model->registration_ID == "Root" )
     {
         if( root_node->children_index.size() == 1)
         {
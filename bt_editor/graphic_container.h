@@ -7,6 +7,7 @@
 
 #include "bt_editor_base.h"
 #include "editor_flowscene.h"
+#include "status_overlay.h"
 
 #include <nodes/Node>
 #include <nodes/NodeData>
@@ -33,6 +34,9 @@ public:
 
     void nodeReorder();
 
+    // changes the layout of the scene and moves the nodes accordingly
+    void setLayout(QtNodes::PortLayout layout);
+
     void zoomHomeView();
 
     bool containsValidTree() const;
@@ -55,6 +59,26 @@ public:
 
     void createSubtree(QtNodes::Node& root_node, QString subtree_name = QString());
 
+    // The tree of the scene, the same of BuildTreeFromScene(scene()), kept up to date
+    // with the signals of the scene and of the nodes. Instance names, ports, positions
+    // and sizes are updated in place; it is rebuilt, at the next call, only after
+    // nodes or connections were created or deleted, or when siblings swap their order.
+    // Modifying the scene may invalidate the reference: copy the tree to keep it.
+    const AbsBehaviorTree& tree();
+
+    // Node of each index of tree().
+    const std::vector<QtNodes::Node*>& nodesByIndex();
+
+    // Status outlines of the monitor and replay modes, indexed like nodesByIndex().
+    // Its geometry is updated when the nodes are moved, created or deleted.
+    // The outlines outside of this area are repainted once they scroll into view.
+    StatusOverlayItem* statusOverlay();
+
+    // Area of the scene shown by the view; empty when the tab is hidden.
+    QRectF visibleSceneRect();
+
+    bool eventFilter(QObject* obj, QEvent* event) override;
+
 public slots:
 
     void onNodeDoubleClicked(QtNodes::Node& root_node);
@@ -69,9 +93,11 @@ public slots:
 
     void onSmartRemove(QtNodes::Node* node);
 
+    void onNodeMoved(QtNodes::Node& node);
+
 signals:
 
-    void addNewModel( const NodeModel &new_model );
+    void addNewModel(const NodeModelPtr &new_model);
 
     void undoableChange();
 
@@ -98,6 +124,33 @@ private:
 
    bool _signal_was_blocked;
 
+   AbsBehaviorTree _tree;
+   bool _tree_valid;
+   std::vector<QtNodes::Node*> _nodes_by_index;
+   std::vector<int> _parent_index;
+   std::unordered_map<const QtNodes::Node*, int> _index_by_node;
+
+   StatusOverlayItem* _status_overlay;
+   bool _overlay_geometry_valid;
+   bool _overlay_refresh_scheduled;
+
+   QRectF _visible_rect;
+   bool _visible_rect_valid;
+   bool _flush_scheduled;
+   bool _selection_update_scheduled;
+
+   // the geometry of the overlay is wrong: update it as soon as the scene is consistent
+   void invalidateNodesGeometry();
+
+   // nodes or connections were created or deleted
+   void invalidateTree();
+
+   // copies the instance name, ports, position and size of the node into tree()
+   void updateTreeNode(QtNodes::Node& node);
+
+   // the nodes dragged together with the one that emitted nodeMoved
+   void updateSelectedNodes();
+
 };
 
 #endif // GRAPHIC_CONTAINER_H
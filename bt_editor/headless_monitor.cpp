@@ -0,0 +1,159 @@
+#include "headless_monitor.h"
+#include <QDebug>
+#include <algorithm>
+#include <iomanip>
+
+#include "utils.h"
+#include "monitor_protocol.h"
+
+namespace {
+const int TREE_REQUEST_TIMEOUT_MS = 1000;
+const int MIN_RETRY_DELAY_MS = 500;
+const int MAX_RETRY_DELAY_MS = 8000;
+}
+
+HeadlessMonitor::HeadlessMonitor(const std::string& address_pub,
+                                 const std::string& address_req,
+                                 const MonitorPolicy& policy,
+                                 double summary_period,
+                                 QObject* parent):
+    QObject(parent),
+    _zmq_context(1),
+    _receiver(_zmq_context),
+    _address_pub(address_pub),
+    _address_req(address_req),
+    _policy(policy),
+    _summary_period(summary_period),
+    _tree_loaded(false),
+    _retry_delay_ms(0)
+{
+    _timer = new QTimer(this);
+    connect( _timer, &QTimer::timeout, this, &HeadlessMonitor::on_timer );
+}
+
+HeadlessMonitor::~HeadlessMonitor()
+{
+    _receiver.stop();
+}
+
+void HeadlessMonitor::start()
+{
+    _receiver.addConnection( 0, _address_pub, _policy );
+    _next_request = std::chrono::steady_clock::now();
+    _since_start.start();
+    _since_summary.start();
+    // there is nothing to paint: a slower pace than the GUI is enough
+    _timer->start(50);
+}
+
+bool HeadlessMonitor::fetchTree()
+{
+    zmq::message_t reply;
+    try{
+        if( !RequestTreeFromServer( _zmq_context, _address_req, TREE_REQUEST_TIMEOUT_MS, reply ) )
+        {
+            return false;
+        }
+    }
+    catch( zmq::error_t& err)
+    {
+        qDebug() << "ZMQ client receive failed: " << err.what();
+        return false;
+    }
+
+    auto fb_behavior_tree = Serialization::GetBehaviorTree( reply.data() );
+    auto res_pair = BuildTreeFromFlatbuffers( fb_behavior_tree );
+    _tree = std::move( res_pair.first );
+    _receiver.setTree( 0, res_pair.second );
+
+    _statistics.reset( _tree.nodesCount() );
+    _ticks_at_summary.assign( _tree.nodesCount(), 0 );
+    std::cout << "Monitoring " << _address_pub << ": " << _tree.nodesCount() -1 << " nodes" << std::endl;
+    return true;
+}
+
+void HeadlessMonitor::on_timer()
+{
+    if( !_tree_loaded && std::chrono::steady_clock::now() >= _next_request )
+    {
+        _tree_loaded = fetchTree();
+        if( !_tree_loaded )
+        {
+            _retry_delay_ms = std::min( MAX_RETRY_DELAY_MS,
+                                        std::max( MIN_RETRY_DELAY_MS, _retry_delay_ms * 2 ) );
+            _next_request = std::chrono::steady_clock::now() + std::chrono::milliseconds( _retry_delay_ms );
+            std::cerr << "Waiting for the server at " << _address_req << std::endl;
+        }
+        else{
+            _retry_delay_ms = 0;
+        }
+    }
+
+    while( _receiver.pop( _batch ) )
+    {
+        if( _batch.reload_tree )
+        {
+            printSummary( std::cout );
+            std::cout << "The tree changed, reloading it" << std::endl;
+            _tree_loaded = false;
+            _next_request = std::chrono::steady_clock::now();
+            continue;
+        }
+        if( !_tree_loaded )
+        {
+            continue;
+        }
+        for (const auto& record: _batch.transitions)
+        {
+            _statistics.addTransition( record.index,
+                                       static_cast<NodeStatus>(record.prev_status),
+                                       static_cast<NodeStatus>(record.status),
+                                       record.timestamp() );
+        }
+    }
+
+    if( _summary_period > 0 && _since_summary.elapsed() >= _summary_period * 1000 )
+    {
+        printSummary( std::cout );
+    }
+}
+
+void HeadlessMonitor::printSummary(std::ostream& out)
+{
+    const double period = std::max( 0.001, _since_summary.restart() * 0.001 );
+    const MonitorCounters& counters = _receiver.counters();
+
+    out << "[" << std::fixed << std::setprecision(0) << _since_start.elapsed() * 0.001 << " s] "
+        << "messages: " << counters.messages.load()
+        << "  dropped: " << counters.dropped.load()
+        << "  transitions: " << _statistics.transitionsCount() << "\n";
+
+    if( !_tree_loaded )
+    {
+        out << "  waiting for the tree" << std::endl;
+        return;
+    }
+
+    out << "  " << std::left << std::setw(32) << "node" << std::right
+        << std::setw(10) << "ticks" << std::setw(10) << "ticks/s"
+        << std::setw(10) << "failures" << std::setw(14) << "longest [s]" << "\n";
+
+    const auto& nodes = _statistics.nodes();
+    for (size_t index = 1; index < nodes.size(); index++)
+    {
+        const auto& node = nodes[index];
+        const uint64_t new_ticks = node.ticks - _ticks_at_summary[index];
+        _ticks_at_summary[index] = node.ticks;
+        if( node.ticks == 0 )
+        {
+            continue;
+        }
+        const QString name = _tree.node(index)->instance_name.left(31);
+        out << "  " << std::left << std::setw(32) << name.toStdString() << std::right
+            << std::setw(10) << node.ticks
+            << std::setw(10) << std::setprecision(1) << new_ticks / period
+            << std::setw(10) << node.failure_count
+            << std::setw(14) << std::setprecision(3) << node.longest_running << "\n";
+    }
+    out << std::flush;
+}
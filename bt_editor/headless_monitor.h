@@ -0,0 +1,64 @@
+#ifndef HEADLESS_MONITOR_H
+#define HEADLESS_MONITOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <chrono>
+#include <iostream>
+#include <zmq.hpp>
+
+#include "bt_editor_base.h"
+#include "monitor_receiver.h"
+#include "node_statistics.h"
+
+// Monitor mode without widgets (Groot --mode monitor --headless), for CI and soak tests.
+// It shares the receiver and the decoder with SidepanelMonitor, aggregates the
+// per-node statistics and prints a summary periodically.
+class HeadlessMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    HeadlessMonitor(const std::string& address_pub,
+                    const std::string& address_req,
+                    const MonitorPolicy& policy,
+                    double summary_period,
+                    QObject* parent = nullptr);
+
+    ~HeadlessMonitor();
+
+    void start();
+
+    void printSummary(std::ostream& out);
+
+    const NodeStatistics& statistics() const { return _statistics; }
+
+private slots:
+
+    void on_timer();
+
+private:
+    bool fetchTree();
+
+    zmq::context_t _zmq_context;
+    MonitorReceiver _receiver;
+    std::string _address_pub;
+    std::string _address_req;
+    MonitorPolicy _policy;
+    double _summary_period;
+
+    AbsBehaviorTree _tree;
+    bool _tree_loaded;
+    std::chrono::steady_clock::time_point _next_request;
+    int _retry_delay_ms;
+
+    NodeStatistics _statistics;
+    MonitorStatusBatch _batch;
+    QTimer* _timer;
+    QElapsedTimer _since_start;
+    QElapsedTimer _since_summary;
+    std::vector<uint64_t> _ticks_at_summary;
+};
+
+#endif // HEADLESS_MONITOR_H
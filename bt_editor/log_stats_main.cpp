@@ -0,0 +1,277 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+#include "replay_log.h"
+#include "node_statistics.h"
+
+// Batch statistics of a directory of .fbl logs. It uses only QtCore:
+// neither a display nor a QApplication is needed.
+
+struct LogResult
+{
+    QString filename;
+    QString error;
+    double start_time;
+    double duration;
+    size_t ticks_count;
+    AbsBehaviorTree tree;
+    NodeStatistics statistics;
+};
+
+static void ProcessLog(LogResult& result)
+{
+    QFile file( result.filename );
+    if( !file.open( QIODevice::ReadOnly ) )
+    {
+        result.error = "can't open the file";
+        return;
+    }
+    const QByteArray content = file.readAll();
+    file.close();
+
+    try {
+        ReplayLog log = ReadReplayLog( content );
+
+        result.statistics.reset( log.tree.nodesCount() );
+        for (const auto& trans: log.transitions)
+        {
+            result.statistics.addTransition( trans.index, trans.prev_status,
+                                             trans.status, trans.timestamp );
+        }
+        result.ticks_count = SegmentTicks( log.transitions ).size();
+        if( !log.transitions.empty() )
+        {
+            result.start_time = log.transitions.front().timestamp;
+            result.duration = log.transitions.back().timestamp - result.start_time;
+        }
+        result.tree = std::move( log.tree );
+    }
+    catch( std::exception& err )
+    {
+        result.error = err.what();
+    }
+}
+
+static QString CsvField(const QString& str)
+{
+    if( str.contains(',') || str.contains('"') || str.contains('\n') || str.contains('\r') )
+    {
+        return "\"" + QString(str).replace("\"", "\"\"") + "\"";
+    }
+    return str;
+}
+
+static void WriteCSV(const std::vector<LogResult>& results, QTextStream& out)
+{
+    out << "file,start_time,index,instance_name,registration_ID,"
+           "ticks,success,failure,failure_rate,"
+           "running_count,running_p50,running_p90,running_p99,running_max\n";
+
+    for (const auto& result: results)
+    {
+        if( !result.error.isEmpty() ) continue;
+
+        const QString filename = QFileInfo( result.filename ).fileName();
+        const auto& nodes = result.statistics.nodes();
+        for (size_t index = 0; index < nodes.size(); index++)
+        {
+            const auto& model = result.tree.node(index)->model;
+            const auto& node = nodes[index];
+            const auto& running = node.running_durations;
+            out << CsvField( filename ) << ","
+                << QString::number( result.start_time, 'f', 6 ) << ","
+                << qulonglong( index ) << ","
+                << CsvField( result.tree.node(index)->instance_name ) << ","
+                << CsvField( model->registration_ID ) << ","
+                << qulonglong( node.ticks ) << ","
+                << qulonglong( node.success_count ) << ","
+                << qulonglong( node.failure_count ) << ","
+                << node.failureRate() << ","
+                << qulonglong( running.count() ) << ","
+                << running.percentile( 0.50 ) << ","
+                << running.percentile( 0.90 ) << ","
+                << running.percentile( 0.99 ) << ","
+                << running.max() << "\n";
+        }
+    }
+}
+
+static QJsonDocument CreateJSON(const std::vector<LogResult>& results)
+{
+    QJsonArray logs;
+    for (const auto& result: results)
+    {
+        QJsonObject log;
+        log["file"] = QFileInfo( result.filename ).fileName();
+        if( !result.error.isEmpty() )
+        {
+            log["error"] = result.error;
+            logs.append( log );
+            continue;
+        }
+        log["start_time"] = result.start_time;
+        log["duration"] = result.duration;
+        log["ticks"] = static_cast<qint64>( result.ticks_count );
+        log["transitions"] = static_cast<qint64>( result.statistics.transitionsCount() );
+
+        QJsonArray json_nodes;
+        const auto& nodes = result.statistics.nodes();
+        for (size_t index = 0; index < nodes.size(); index++)
+        {
+            const auto& node = nodes[index];
+            const auto& running = node.running_durations;
+
+            QJsonObject json_running;
+            json_running["count"] = static_cast<qint64>( running.count() );
+            json_running["p50"] = running.percentile( 0.50 );
+            json_running["p90"] = running.percentile( 0.90 );
+            json_running["p99"] = running.percentile( 0.99 );
+            json_running["max"] = running.max();
+
+            QJsonObject json_node;
+            json_node["index"] = static_cast<int>( index );
+            json_node["instance_name"] = result.tree.node(index)->instance_name;
+            json_node["registration_ID"] = result.tree.node(index)->model->registration_ID;
+            json_node["ticks"] = static_cast<qint64>( node.ticks );
+            json_node["success"] = static_cast<qint64>( node.success_count );
+            json_node["failure"] = static_cast<qint64>( node.failure_count );
+            json_node["failure_rate"] = node.failureRate();
+            json_node["running"] = json_running;
+            json_nodes.append( json_node );
+        }
+        log["nodes"] = json_nodes;
+        logs.append( log );
+    }
+    QJsonObject root;
+    root["logs"] = logs;
+    return QJsonDocument( root );
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("groot_log_stats");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Per-node statistics of a directory of BehaviorTree logs (*.fbl)");
+    parser.addHelpOption();
+    parser.addPositionalArgument("directory", "Directory containing the .fbl files");
+
+    QCommandLineOption csv_option("csv", "Write the statistics as CSV into <file> (\"-\" for stdout)", "file");
+    parser.addOption(csv_option);
+
+    QCommandLineOption json_option("json", "Write the statistics as JSON into <file>", "file");
+    parser.addOption(json_option);
+
+    QCommandLineOption jobs_option("jobs", "Number of logs processed in parallel (default: one per core)", "N");
+    parser.addOption(jobs_option);
+
+    parser.process( app );
+
+    if( parser.positionalArguments().size() != 1 )
+    {
+        parser.showHelp(1);
+    }
+
+    QDir dir( parser.positionalArguments().front() );
+    if( !dir.exists() )
+    {
+        std::cerr << "Directory not found: " << dir.path().toStdString() << std::endl;
+        return 1;
+    }
+
+    const QStringList files = dir.entryList( QStringList() << "*.fbl", QDir::Files, QDir::Name );
+
+    std::vector<LogResult> results( files.size() );
+    for (int i = 0; i < files.size(); i++)
+    {
+        results[i].filename = dir.filePath( files[i] );
+        results[i].start_time = 0;
+        results[i].duration = 0;
+        results[i].ticks_count = 0;
+    }
+
+    int jobs = parser.value(jobs_option).toInt();
+    if( jobs <= 0 )
+    {
+        jobs = std::max( 1, QThread::idealThreadCount() );
+    }
+
+    // one log per thread at a time, each result is written by a single worker
+    std::atomic<size_t> next_log(0);
+    auto worker = [&]()
+    {
+        size_t index;
+        while( (index = next_log.fetch_add(1)) < results.size() )
+        {
+            ProcessLog( results[index] );
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < jobs; i++)
+    {
+        threads.emplace_back( worker );
+    }
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+
+    int failed = 0;
+    for (const auto& result: results)
+    {
+        if( !result.error.isEmpty() )
+        {
+            std::cerr << "Skipping " << result.filename.toStdString()
+                      << ": " << result.error.toStdString() << std::endl;
+            failed++;
+        }
+    }
+
+    if( parser.isSet(json_option) )
+    {
+        QFile file( parser.value(json_option) );
+        if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+        {
+            std::cerr << "Can't write " << file.fileName().toStdString() << std::endl;
+            return 1;
+        }
+        file.write( CreateJSON( results ).toJson() );
+    }
+
+    // CSV on stdout, unless an output file was requested
+    const bool csv_on_stdout = ( parser.value(csv_option) == "-" ) ||
+                               ( !parser.isSet(csv_option) && !parser.isSet(json_option) );
+    if( csv_on_stdout )
+    {
+        QTextStream out( stdout );
+        WriteCSV( results, out );
+    }
+    else if( parser.isSet(csv_option) )
+    {
+        QFile file( parser.value(csv_option) );
+        if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+        {
+            std::cerr << "Can't write " << file.fileName().toStdString() << std::endl;
+            return 1;
+        }
+        QTextStream out( &file );
+        WriteCSV( results, out );
+    }
+
+    std::cerr << "Processed " << (results.size() - failed) << " of "
+              << results.size() << " logs" << std::endl;
+    return failed == 0 ? 0 : 2;
+}
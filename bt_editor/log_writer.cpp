@@ -0,0 +1,151 @@
+#include "log_writer.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+namespace {
+// data appended to the last chunk of the queue, as long as it is smaller than this
+const size_t MAX_CHUNK_SIZE = 256*1024;
+}
+
+LogWriter::LogWriter(size_t max_queued_bytes):
+    _max_queued_bytes(max_queued_bytes),
+    _queued_bytes(0),
+    _busy(false),
+    _stop(false),
+    _bytes_written(0),
+    _failed(false)
+{
+    _thread = std::thread( &LogWriter::loop, this );
+}
+
+LogWriter::~LogWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _stop = true;
+    }
+    _cv_writer.notify_one();
+    _thread.join();
+}
+
+void LogWriter::openFile(const std::string& filename, const std::string& tree_buffer)
+{
+    Chunk chunk;
+    chunk.open_file = true;
+    chunk.filename = filename;
+
+    const uint32_t size = tree_buffer.size();
+    const char header[4] = { char(size & 0xFF), char((size >> 8) & 0xFF),
+                             char((size >> 16) & 0xFF), char((size >> 24) & 0xFF) };
+    chunk.data.reserve( 4 + tree_buffer.size() );
+    chunk.data.append( header, 4 );
+    chunk.data.append( tree_buffer );
+
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _queued_bytes += chunk.data.size();
+        _queue.push_back( std::move(chunk) );
+    }
+    _cv_writer.notify_one();
+}
+
+void LogWriter::append(const char* data, size_t size)
+{
+    {
+        std::unique_lock<std::mutex> lock( _mutex );
+        _cv_producer.wait( lock, [&]() {
+            return _queued_bytes == 0 || _queued_bytes + size <= _max_queued_bytes;
+        });
+
+        if( !_queue.empty() && !_queue.back().open_file &&
+            _queue.back().data.size() < MAX_CHUNK_SIZE )
+        {
+            _queue.back().data.append( data, size );
+        }
+        else{
+            Chunk chunk;
+            chunk.open_file = false;
+            chunk.data.reserve( std::max( size, MAX_CHUNK_SIZE ) );
+            chunk.data.append( data, size );
+            _queue.push_back( std::move(chunk) );
+        }
+        _queued_bytes += size;
+    }
+    _cv_writer.notify_one();
+}
+
+void LogWriter::flush()
+{
+    std::unique_lock<std::mutex> lock( _mutex );
+    _cv_producer.wait( lock, [&]() { return _queue.empty() && !_busy; } );
+}
+
+bool LogWriter::writeAll(int fd, const char* data, size_t size)
+{
+    while( size > 0 )
+    {
+        const ssize_t written = ::write( fd, data, size );
+        if( written < 0 )
+        {
+            if( errno == EINTR ) continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+        _bytes_written += written;
+    }
+    return true;
+}
+
+void LogWriter::loop()
+{
+    int fd = -1;
+    std::deque<Chunk> pending;
+
+    while( true )
+    {
+        {
+            std::unique_lock<std::mutex> lock( _mutex );
+            _cv_writer.wait( lock, [&]() { return _stop || !_queue.empty(); } );
+            if( _queue.empty() && _stop )
+            {
+                break;
+            }
+            pending.swap( _queue );
+            _queued_bytes = 0;
+            _busy = true;
+        }
+        _cv_producer.notify_all();
+
+        for (auto& chunk: pending)
+        {
+            if( chunk.open_file )
+            {
+                if( fd >= 0 ) ::close( fd );
+                fd = ::open( chunk.filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+                if( fd < 0 )
+                {
+                    perror( chunk.filename.c_str() );
+                    _failed = true;
+                }
+            }
+            if( fd >= 0 && !writeAll( fd, chunk.data.data(), chunk.data.size() ) )
+            {
+                perror( "LogWriter" );
+                _failed = true;
+            }
+        }
+        pending.clear();
+
+        {
+            std::lock_guard<std::mutex> lock( _mutex );
+            _busy = false;
+        }
+        _cv_producer.notify_all();
+    }
+
+    if( fd >= 0 ) ::close( fd );
+}
@@ -0,0 +1,64 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes .fbl files from a background thread.
+//
+// The producer appends raw transitions (12 bytes each) into a bounded queue;
+// the writer thread takes everything that is pending and writes it with a
+// single write() call. When the queue is full, append() blocks.
+class LogWriter
+{
+public:
+    explicit LogWriter(size_t max_queued_bytes = 64*1024*1024);
+
+    // flushes the pending data and closes the file
+    ~LogWriter();
+
+    // Closes the current file (after its pending data is written) and opens
+    // a new one, starting with the header (size + flatbuffers of the tree).
+    void openFile(const std::string& filename, const std::string& tree_buffer);
+
+    void append(const char* data, size_t size);
+
+    // wait until everything queued so far has been written
+    void flush();
+
+    uint64_t bytesWritten() const { return _bytes_written.load(); }
+
+    bool hasFailed() const { return _failed.load(); }
+
+private:
+    struct Chunk
+    {
+        bool open_file;
+        std::string filename;
+        std::string data;
+    };
+
+    void loop();
+
+    bool writeAll(int fd, const char* data, size_t size);
+
+    const size_t _max_queued_bytes;
+
+    std::mutex _mutex;
+    std::condition_variable _cv_writer;
+    std::condition_variable _cv_producer;
+    std::deque<Chunk> _queue;
+    size_t _queued_bytes;
+    bool _busy;
+    bool _stop;
+
+    std::atomic<uint64_t> _bytes_written;
+    std::atomic<bool> _failed;
+    std::thread _thread;
+};
+
+#endif // LOG_WRITER_H
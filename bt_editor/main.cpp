@@ -1,6 +1,11 @@
 #include <QCommandLineParser>
 #include <QApplication>
 #include <QDialog>
+#include <QFile>
+#include <QScopedPointer>
+#include <QTimer>
+#include <csignal>
+#include <iostream>
 #include <nodes/NodeStyle>
 #include <nodes/FlowViewStyle>
 #include <nodes/ConnectionStyle>
@@ -10,20 +15,112 @@
 #include "XML_utilities.hpp"
 #include "startup_dialog.h"
 #include "models/RootNodeModel.hpp"
+#include "replay_renderer.h"
+#ifdef ZMQ_FOUND
+#include "headless_monitor.h"
+#endif
 
 using QtNodes::DataModelRegistry;
 using QtNodes::FlowViewStyle;
 using QtNodes::NodeStyle;
 using QtNodes::ConnectionStyle;
 
+static int
+renderReplay(const QString& log_file, const ReplayRenderOptions& options)
+{
+    QFile file(log_file);
+    if( !file.open(QIODevice::ReadOnly) )
+    {
+        std::cerr << "Can't open the file " << log_file.toStdString() << std::endl;
+        return 1;
+    }
+
+    ReplayLog log;
+    try{
+        log = ReadReplayLog( file.readAll() );
+    }
+    catch( std::exception& err )
+    {
+        std::cerr << "Failed to load " << log_file.toStdString() << ": " << err.what() << std::endl;
+        return 1;
+    }
+
+    // the window is never shown, it just owns the models and the scene
+    MainWindow win( GraphicMode::REPLAY );
+    for (const auto& tree_node: log.tree.nodes() )
+    {
+        if( BuiltinNodeModels().count( tree_node.model->registration_ID ) == 0)
+        {
+            win.onAddToModelRegistry( tree_node.model );
+        }
+    }
+    win.onCreateAbsBehaviorTree( log.tree, "BehaviorTree", false );
+
+    int frames = RenderReplayFrames( *win.getTabByName("BehaviorTree")->scene(),
+                                     log.transitions, options );
+    if( frames < 0 )
+    {
+        return 1;
+    }
+    std::cout << frames << " frames written into " << options.output_dir.toStdString() << std::endl;
+    return 0;
+}
+
+#ifdef ZMQ_FOUND
+
+static volatile std::sig_atomic_t g_stop_headless = 0;
+
+static void HeadlessSignalHandler(int)
+{
+    g_stop_headless = 1;
+}
+
+static int
+runHeadlessMonitor(QCoreApplication& app, const std::string& address,
+                   const std::string& publisher_port, const std::string& server_port,
+                   const MonitorPolicy& policy, double summary_period)
+{
+    HeadlessMonitor monitor( "tcp://" + address + ":" + publisher_port,
+                             "tcp://" + address + ":" + server_port,
+                             policy, summary_period );
+
+    std::signal( SIGINT, HeadlessSignalHandler );
+    std::signal( SIGTERM, HeadlessSignalHandler );
+    QTimer stop_timer;
+    QObject::connect( &stop_timer, &QTimer::timeout, [&app]()
+    {
+        if( g_stop_headless ) app.quit();
+    });
+    stop_timer.start(100);
+
+    monitor.start();
+    const int ret = app.exec();
+    monitor.printSummary( std::cout );
+    return ret;
+}
+#endif
+
 int
 main(int argc, char *argv[])
 {
-    QApplication app(argc, argv);
-    app.setApplicationName("Groot");
-    app.setWindowIcon(QPixmap(":/icons/BT.png"));
-    app.setOrganizationName("EurecatRobotics");
-    app.setOrganizationDomain("eurecat.org");
+    bool headless = false;
+    for (int i = 1; i < argc; i++)
+    {
+        // rendering a replay into images doesn't need a display
+        if( QByteArray(argv[i]).startsWith("--render-frames") &&
+            qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM") )
+        {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        // no widgets at all
+        headless |= ( QByteArray(argv[i]) == "--headless" );
+    }
+
+    QScopedPointer<QCoreApplication> app( headless ? new QCoreApplication(argc, argv) :
+                                                     new QApplication(argc, argv) );
+    app->setApplicationName("Groot");
+    app->setOrganizationName("EurecatRobotics");
+    app->setOrganizationDomain("eurecat.org");
 
     qRegisterMetaType<AbsBehaviorTree>();
 
@@ -39,12 +136,108 @@ main(int argc, char *argv[])
                                    "Start in one of these modes: [editor,monitor,replay]",
                                    "mode");
     parser.addOption(mode_option);
-    parser.process( app );
+
+    QCommandLineOption render_option(QStringList() << "render-frames",
+                                     "Render a log file (.fbl) into a sequence of PNG images, without opening any window",
+                                     "log_file");
+    parser.addOption(render_option);
+
+    QCommandLineOption output_option(QStringList() << "output",
+                                     "Directory of the rendered images (default: ./frames)",
+                                     "directory", "frames");
+    parser.addOption(output_option);
+
+    QCommandLineOption fps_option(QStringList() << "fps",
+                                  "Images rendered per second of the log (default: 10)",
+                                  "fps", "10");
+    parser.addOption(fps_option);
+
+    QCommandLineOption headless_option(QStringList() << "headless",
+                                       "With --mode monitor: print the statistics of the nodes periodically, without GUI");
+    parser.addOption(headless_option);
+
+    QCommandLineOption address_option(QStringList() << "address",
+                                      "Headless monitor: address of the robot (default: localhost)",
+                                      "address", "localhost");
+    parser.addOption(address_option);
+
+    QCommandLineOption publisher_option(QStringList() << "publisher_port",
+                                        "Headless monitor: port of the publisher (default: 1666)",
+                                        "port", "1666");
+    parser.addOption(publisher_option);
+
+    QCommandLineOption server_option(QStringList() << "server_port",
+                                     "Headless monitor: port of the server (default: 1667)",
+                                     "port", "1667");
+    parser.addOption(server_option);
+
+    QCommandLineOption policy_option(QStringList() << "policy",
+                                     "Headless monitor: one of [lossless,conflate,sample] (default: lossless)",
+                                     "policy", "lossless");
+    parser.addOption(policy_option);
+
+    QCommandLineOption sample_rate_option(QStringList() << "sample-rate",
+                                          "Headless monitor: messages per second, with --policy sample (default: 10)",
+                                          "hz", "10");
+    parser.addOption(sample_rate_option);
+
+    QCommandLineOption summary_option(QStringList() << "summary",
+                                      "Headless monitor: print the summary every <seconds> (default: 10)",
+                                      "seconds", "10");
+    parser.addOption(summary_option);
+
+    parser.process( *app );
+
+    if( headless )
+    {
+        if( parser.value(mode_option) != "monitor" )
+        {
+            std::cerr << "--headless requires --mode monitor" << std::endl;
+            return 1;
+        }
+#ifdef ZMQ_FOUND
+        MonitorPolicy policy( MonitorPolicy::LOSSLESS, parser.value(sample_rate_option).toDouble() );
+        const QString policy_name = parser.value(policy_option);
+        if( policy_name == "conflate" )
+        {
+            policy.mode = MonitorPolicy::CONFLATE;
+        }
+        else if( policy_name == "sample" )
+        {
+            policy.mode = MonitorPolicy::SAMPLE;
+        }
+        else if( policy_name != "lossless" )
+        {
+            std::cerr << "wrong policy passed to --policy. Use one of these: lossless / conflate / sample"
+                      << std::endl;
+            return 1;
+        }
+        return runHeadlessMonitor( *app,
+                                   parser.value(address_option).toStdString(),
+                                   parser.value(publisher_option).toStdString(),
+                                   parser.value(server_option).toStdString(),
+                                   policy,
+                                   parser.value(summary_option).toDouble() );
+#else
+        std::cerr << "Groot was built without ZeroMQ: monitor mode is not available" << std::endl;
+        return 1;
+#endif
+    }
+
+    QApplication::setWindowIcon(QPixmap(":/icons/BT.png"));
 
     QFile styleFile( ":/stylesheet.qss" );
     styleFile.open( QFile::ReadOnly );
     QString style( styleFile.readAll() );
-    app.setStyleSheet( style );
+    qApp->setStyleSheet( style );
+
+    if( parser.isSet(render_option) )
+    {
+        ReplayRenderOptions options;
+        options.output_dir = parser.value(output_option);
+        options.fps = parser.value(fps_option).toDouble();
+        return renderReplay( parser.value(render_option), options );
+    }
 
     if( parser.isSet(test_option) )
     {
@@ -52,7 +245,7 @@ main(int argc, char *argv[])
         win.setWindowTitle("Groot");
         win.show();
         win.loadFromXML( ":/crossdoor_with_subtree.xml" );
-        return app.exec();
+        return app->exec();
     }
     else{
         auto mode = GraphicMode::EDITOR;
@@ -90,6 +283,6 @@ main(int argc, char *argv[])
 
         MainWindow win( mode );
         win.show();
-        return app.exec();
+        return app->exec();
     }
 }
@@ -65,9 +65,9 @@ MainWindow::MainWindow(GraphicMode initial_mode, QWidget *parent) :
 
     //------------------------------------------------------
 
-    auto registerModel = [this](const QString& ID, const NodeModel& model)
+    auto registerModel = [this](const QString& ID, const NodeModelPtr& model)
     {
-        QString category = QString::fromStdString( BT::toStr(model.type) );
+        QString category = QString::fromStdString( BT::toStr(model->type) );
         if( ID == "Root")
         {
             category = "Root";
@@ -187,8 +187,14 @@ MainWindow::MainWindow(GraphicMode initial_mode, QWidget *parent) :
     connect( _monitor_widget, &SidepanelMonitor::changeNodeStyle,
             this, &MainWindow::onChangeNodesStatus);
 
+    connect( _monitor_widget, &SidepanelMonitor::changeNodeHeat,
+            this, &MainWindow::onChangeNodesHeat);
+
     connect( _monitor_widget, &SidepanelMonitor::loadBehaviorTree,
             this, createSingleTabBehaviorTree );
+
+    connect( _monitor_widget, &SidepanelMonitor::closeBehaviorTree,
+            this, &MainWindow::onCloseBehaviorTree );
 #endif
 
     ui->tabWidget->tabBar()->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -451,10 +457,10 @@ QString MainWindow::saveToXML() const
         auto& container = it.second;
         auto  scene = container->scene();
 
-        auto abs_tree = BuildTreeFromScene(container->scene());
+        const auto& abs_tree = container->tree();
         auto abs_root = abs_tree.rootNode();
         if( abs_root->children_index.size() == 1 &&
-            abs_root->model.registration_ID == "Root"  )
+            abs_root->model->registration_ID == "Root"  )
         {
             // mofe to the child of ROOT
             abs_root = abs_tree.node( abs_root->children_index.front() );
@@ -484,13 +490,13 @@ QString MainWindow::saveToXML() const
             continue;
         }
 
-        QDomElement node = doc.createElement( QString::fromStdString(toStr(model.type)) );
+        QDomElement node = doc.createElement( QString::fromStdString(toStr(model->type)) );
 
         if( !node.isNull() )
         {
             node.setAttribute("ID", ID);
 
-            for(const auto& port_it: model.ports)
+            for(const auto& port_it: model->ports)
             {
                 const auto& port_name = port_it.first;
                 const auto& port = port_it.second;
@@ -752,7 +758,9 @@ MainWindow::SavedState MainWindow::saveCurrentState()
 
     for (auto& it: _tab_info)
     {
-        saved.json_states[it.first] = it.second->scene()->saveToMemory();
+        const QByteArray json = it.second->scene()->saveToMemory();
+        saved.json_hashes[it.first] = ContentHash( json );
+        saved.json_states[it.first] = json;
     }
     return saved;
 }
@@ -887,26 +895,55 @@ void MainWindow::onRequestSubTreeExpand(GraphicContainer& container,
 }
 
 
-void MainWindow::onAddToModelRegistry(const NodeModel &model)
+void MainWindow::onAddToModelRegistry(const NodeModelPtr &model)
 {
     namespace util = QtNodes::detail;
-    const auto& ID = model.registration_ID;
+    const auto& ID = model->registration_ID;
 
     DataModelRegistry::RegistryItemCreator node_creator = [model]() -> DataModelRegistry::RegistryItemPtr
     {
-        if( model.type == NodeType::SUBTREE)
+        if( model->type == NodeType::SUBTREE)
         {
             return util::make_unique<SubtreeNodeModel>(model);
         }
         return util::make_unique<BehaviorTreeDataModel>(model);
     };
 
-    _model_registry->registerModel( QString::fromStdString( toStr(model.type)), node_creator, ID);
+    _model_registry->registerModel( QString::fromStdString( toStr(model->type)), node_creator, ID);
 
     _treenode_models.insert( {ID, model } );
     _editor_widget->updateTreeView();
 }
 
+void MainWindow::onCloseBehaviorTree(const QString &bt_name)
+{
+    auto container = getTabByName( bt_name );
+    if( !container )
+    {
+        return;
+    }
+    if( ui->tabWidget->count() == 1 )
+    {
+        container->clearScene();
+        return;
+    }
+    for( int index = 0; index < ui->tabWidget->count(); index++)
+    {
+        if( ui->tabWidget->tabText(index) == bt_name )
+        {
+            container->clearScene();
+            container->deleteLater();
+            ui->tabWidget->removeTab( index );
+            _tab_info.erase( bt_name );
+            break;
+        }
+    }
+    if( ui->tabWidget->count() == 1 )
+    {
+        onTabSetMainTree(0);
+    }
+}
+
 void MainWindow::onDestroySubTree(const QString &ID)
 {
     auto sub_container = getTabByName(ID);
@@ -918,7 +955,8 @@ void MainWindow::onDestroySubTree(const QString &ID)
             continue;
         }
         auto container = it.second;
-        auto tree = BuildTreeFromScene(container->scene());
+        // copied: the loop modifies the scene
+        auto tree = container->tree();
         for( const auto& abs_node: tree.nodes())
         {
             auto qt_node = abs_node.graphic_node;
@@ -973,7 +1011,7 @@ void MainWindow::onModelRemoveRequested(QString ID)
             QtNodes::Node* graphic_node = node_it.second.get();
             auto bt_node = dynamic_cast<BehaviorTreeDataModel*>( graphic_node->nodeDataModel() );
 
-            if( bt_node->model().registration_ID == ID )
+            if( bt_node->model()->registration_ID == ID )
             {
                 node_found = bt_node;
                 tab_containing_node = it.first;
@@ -992,7 +1030,7 @@ void MainWindow::onModelRemoveRequested(QString ID)
         return;
     }
 
-    NodeType node_type = _treenode_models.at(ID).type;
+    NodeType node_type = _treenode_models.at(ID)->type;
 
     if( node_found && node_type != NodeType::SUBTREE )
     {
@@ -1005,7 +1043,7 @@ void MainWindow::onModelRemoveRequested(QString ID)
     else
     {
         int ret = QMessageBox::Cancel;
-        if( node_found->model().type != NodeType::SUBTREE )
+        if( node_found->model()->type != NodeType::SUBTREE )
         {
             ret = QMessageBox::warning(this,"Delete TreeNode Model?",
                                        "Are you sure? This action can't be undone.",
@@ -1041,7 +1079,7 @@ QtNodes::Node* MainWindow::subTreeExpand(GraphicContainer &container,
     if( option == SUBTREE_EXPAND && subtree_model->expanded() == false)
     {
         auto subtree_container = getTabByName(subtree_name);
-        auto abs_subtree = BuildTreeFromScene( subtree_container->scene() );
+        auto abs_subtree = subtree_container->tree();
 
         subtree_model->setExpanded(true);
         node.nodeState().getEntries(PortType::Out).resize(1);
@@ -1097,7 +1135,7 @@ QtNodes::Node* MainWindow::subTreeExpand(GraphicContainer &container,
         QtNodes::Node* child_node = conn_out.begin()->second->getNode( PortType::In );
 
         auto subtree_container = getTabByName(subtree_name);
-        auto subtree = BuildTreeFromScene( subtree_container->scene() );
+        auto subtree = subtree_container->tree();
 
         container.deleteSubTreeRecursively( *child_node );
         container.appendTreeToNode( node, subtree );
@@ -1144,9 +1182,9 @@ void MainWindow::onCreateAbsBehaviorTree(const AbsBehaviorTree &tree,
     if( secondary_tabs ){
       for(const auto& node: tree.nodes())
       {
-        if( node.model.type == NodeType::SUBTREE && getTabByName(node.model.registration_ID) == nullptr)
+        if( node.model->type == NodeType::SUBTREE && getTabByName(node.model->registration_ID) == nullptr)
         {
-          createTab(node.model.registration_ID);
+          createTab(node.model->registration_ID);
         }
       }
     }
@@ -1179,7 +1217,7 @@ void MainWindow::onTreeNodeEdited(QString prev_ID, QString new_ID)
                 continue;
             }
 
-            if( bt_node->model().registration_ID == prev_ID )
+            if( bt_node->model()->registration_ID == prev_ID )
             {
                 nodes_to_rename.push_back( graphic_node );
             }
@@ -1190,7 +1228,7 @@ void MainWindow::onTreeNodeEdited(QString prev_ID, QString new_ID)
             auto bt_node = dynamic_cast<BehaviorTreeDataModel*>( graphic_node->nodeDataModel() );
             bool is_expanded_subtree = false;
 
-            if( bt_node->model().type == NodeType::SUBTREE)
+            if( bt_node->model()->type == NodeType::SUBTREE)
             {
                 auto subtree_model = dynamic_cast<SubtreeNodeModel*>( bt_node );
                 if(subtree_model && subtree_model->expanded())
@@ -1308,12 +1346,9 @@ void MainWindow::refreshNodesLayout(QtNodes::PortLayout new_layout)
         const QSignalBlocker blocker( currentTabInfo() );
         for(auto& tab: _tab_info)
         {
-            auto scene = tab.second->scene();
-            if( scene->layout() != new_layout )
+            if( tab.second->scene()->layout() != new_layout )
             {
-                auto abstract_tree = BuildTreeFromScene( scene );
-                scene->setLayout( new_layout );
-                NodeReorder( *scene, abstract_tree );
+                tab.second->setLayout( new_layout );
                 refreshed = true;
             }
         }
@@ -1402,6 +1437,14 @@ void MainWindow::on_actionMonitor_mode_triggered()
     }
     if( res == QMessageBox::Ok)
     {
+        // the sandbox of the monitor runs the tree that was in the editor
+        if( currentTabInfo()->scene()->nodes().size() > 0 )
+        {
+            _monitor_widget->setSandboxTree( saveToXML(), _treenode_models );
+        }
+        else{
+            _monitor_widget->setSandboxTree( QString(), NodeModels() );
+        }
         currentTabInfo()->clearScene();
         _monitor_widget->clear();
         _current_mode = GraphicMode::MONITOR;
@@ -1450,8 +1493,10 @@ void MainWindow::on_tabWidget_currentChanged(int index)
 
 bool MainWindow::SavedState::operator ==(const MainWindow::SavedState &other) const
 {
+    // different hashes are a fast reject; equal ones might be a collision
     if( current_tab_name != other.current_tab_name ||
-        json_states.size() != other.json_states.size())
+        json_hashes != other.json_hashes ||
+        json_states.size() != other.json_states.size() )
     {
         return false;
     }
@@ -1472,33 +1517,19 @@ bool MainWindow::SavedState::operator ==(const MainWindow::SavedState &other) co
     return true;
 }
 
-void MainWindow::resetTreeStyle(AbsBehaviorTree &tree){
+void MainWindow::resetTreeStyle(GraphicContainer& container){
     //printf("resetTreeStyle\n");
-    QtNodes::NodeStyle  node_style;
-    QtNodes::ConnectionStyle conn_style;
-
-    for(auto abs_node: tree.nodes()){
-        auto gui_node = abs_node.graphic_node;
-
-        gui_node->nodeDataModel()->setNodeStyle( node_style );
-        gui_node->nodeGraphicsObject().update();
-
-        const auto& conn_in = gui_node->nodeState().connections(PortType::In, 0 );
-        if(conn_in.size() == 1)
-        {
-            auto conn = conn_in.begin()->second;
-            conn->setStyle( conn_style );
-            conn->connectionGraphicsObject().update();
-        }
-    }
+    container.statusOverlay()->clearStyles();
 }
 
 void MainWindow::onChangeNodesStatus(const QString& bt_name,
                                      const std::vector<std::pair<int, NodeStatus> > &node_status)
 {
-    auto tree = BuildTreeFromScene( getTabByName(bt_name)->scene() );
+    auto container = getTabByName(bt_name);
+    auto overlay = container->statusOverlay();
 
-    std::vector<NodeStatus> vec_last_status(tree.nodesCount());
+    // status of the nodes earlier in the same message; only those are reset at the end
+    _last_status.resize( overlay->size(), NodeStatus::IDLE );
 
     // printf("---\n");
 
@@ -1506,27 +1537,30 @@ void MainWindow::onChangeNodesStatus(const QString& bt_name,
     {
         const int index = it.first;
         const NodeStatus status = it.second;
-        auto& abs_node = tree.nodes().at(index);
 
-        // printf("%3d: %d, %s\n", index, (int)it.second, abs_node.instance_name.toStdString().c_str());
+        // printf("%3d: %d\n", index, (int)it.second);
 
         if(index == 1 && it.second == NodeStatus::RUNNING)
-            resetTreeStyle(tree);
+            resetTreeStyle(*container);
 
-        auto gui_node = abs_node.graphic_node;
-        auto style = getStyleFromStatus( status, vec_last_status[index] );
-        gui_node->nodeDataModel()->setNodeStyle( style.first );
-        gui_node->nodeGraphicsObject().update();
+        overlay->setStyle( index, &getStyleFromStatus( status, _last_status.at(index) ) );
 
-        vec_last_status[index] = status;
+        _last_status[index] = status;
+    }
+    for (auto& it: node_status)
+    {
+        _last_status[it.first] = NodeStatus::IDLE;
+    }
+}
 
-        const auto& conn_in = gui_node->nodeState().connections(PortType::In, 0 );
-        if(conn_in.size() == 1)
-        {
-            auto conn = conn_in.begin()->second;
-            conn->setStyle( style.second );
-            conn->connectionGraphicsObject().update();
-        }
+void MainWindow::onChangeNodesHeat(const QString& bt_name,
+                                   const std::vector<std::pair<int, double>>& node_heat)
+{
+    auto overlay = getTabByName(bt_name)->statusOverlay();
+
+    for (auto& it: node_heat)
+    {
+        overlay->setStyle( it.first, &getStyleFromHeat( it.second ) );
     }
 }
 
@@ -1598,7 +1632,7 @@ void MainWindow::onTabRenameRequested(int tab_index, QString new_name)
     {
         _model_registry->unregisterModel(old_name);
         _treenode_models.erase(old_name);
-        NodeModel model = { NodeType::SUBTREE, new_name, {}};
+        NodeModelPtr model = MakeNodeModel( { NodeType::SUBTREE, new_name, {} } );
         onAddToModelRegistry( model );
         _treenode_models.insert( { new_name, model} );
         _editor_widget->updateTreeView();
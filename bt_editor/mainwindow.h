@@ -57,7 +57,7 @@ public:
 
     const NodeModels &registeredModels() const;
 
-    void resetTreeStyle(AbsBehaviorTree &tree);
+    void resetTreeStyle(GraphicContainer& container);
 
 public slots:
 
@@ -76,10 +76,13 @@ public slots:
     void onRequestSubTreeExpand(GraphicContainer& container,
                                 QtNodes::Node& node);
 
-    void onAddToModelRegistry(const NodeModel& model);
+    void onAddToModelRegistry(const NodeModelPtr& model);
 
     void onDestroySubTree(const QString &ID);
 
+    // removes the tab, or clears it if it is the last one
+    void onCloseBehaviorTree(const QString &bt_name);
+
     void onModelRemoveRequested(QString ID);
 
     virtual void closeEvent(QCloseEvent *event) override;
@@ -100,6 +103,8 @@ public slots:
 
     void onChangeNodesStatus(const QString& bt_name, const std::vector<std::pair<int, NodeStatus>>& node_status);
 
+    void onChangeNodesHeat(const QString& bt_name, const std::vector<std::pair<int, double>>& node_heat);
+
     void on_toolButtonLayout_clicked();
 
     void on_actionEditor_mode_triggered();
@@ -159,6 +164,9 @@ private:
         QTransform view_transform;
         QRectF view_area;
         std::map<QString, QByteArray> json_states;
+        // hashes of json_states, computed once by saveCurrentState(): a fast reject
+        // of operator==
+        std::map<QString, uint64_t> json_hashes;
         bool operator ==( const SavedState& other) const;
         bool operator !=( const SavedState& other) const { return !( *this == other); }
     };
@@ -188,6 +196,9 @@ private:
 
     QString _main_tree;
 
+    // reused by onChangeNodesStatus
+    std::vector<NodeStatus> _last_status;
+
     SidepanelEditor* _editor_widget;
     SidepanelReplay* _replay_widget;
 #ifdef ZMQ_FOUND
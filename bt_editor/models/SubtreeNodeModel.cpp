@@ -2,7 +2,7 @@
 #include <QLineEdit>
 #include <QVBoxLayout>
 
-SubtreeNodeModel::SubtreeNodeModel(const NodeModel &model):
+SubtreeNodeModel::SubtreeNodeModel(const NodeModelPtr &model):
     BehaviorTreeDataModel ( model ),
     _expanded(false)
 {
@@ -9,7 +9,7 @@ class SubtreeNodeModel : public BehaviorTreeDataModel
     Q_OBJECT
 public:
 
-    SubtreeNodeModel(const NodeModel& model);
+    SubtreeNodeModel(const NodeModelPtr& model);
 
     ~SubtreeNodeModel() override = default;
 
@@ -0,0 +1,130 @@
+#include "monitor_history.h"
+#include <algorithm>
+#include <stdexcept>
+
+MonitorHistory::MonitorHistory(size_t capacity, double max_age, size_t keyframe_interval):
+    _ring( std::max<size_t>(capacity, 1) ),
+    _head(0),
+    _size(0),
+    _first_seq(0),
+    _max_age(max_age),
+    _keyframe_interval( std::max<size_t>(keyframe_interval, 1) )
+{
+    _keyframes.resize( _ring.size() / _keyframe_interval + 2 );
+    for (auto& keyframe: _keyframes)
+    {
+        keyframe.valid = false;
+    }
+}
+
+void MonitorHistory::reset(const std::vector<NodeStatus>& initial_status)
+{
+    _head = 0;
+    _size = 0;
+    _first_seq = 0;
+    _baseline_status = initial_status;
+    _baseline_prev.assign( initial_status.size(), NodeStatus::IDLE );
+    _current_status = _baseline_status;
+    _current_prev = _baseline_prev;
+    for (auto& keyframe: _keyframes)
+    {
+        keyframe.valid = false;
+    }
+}
+
+void MonitorHistory::evictOldest()
+{
+    const MonitorRecord& oldest = _ring[_head];
+    if( oldest.index < _baseline_status.size() )
+    {
+        _baseline_prev[oldest.index]   = static_cast<NodeStatus>(oldest.prev_status);
+        _baseline_status[oldest.index] = static_cast<NodeStatus>(oldest.status);
+    }
+    _head = (_head + 1) % _ring.size();
+    _size--;
+    _first_seq++;
+}
+
+void MonitorHistory::push(const MonitorRecord& record)
+{
+    if( _size == _ring.size() )
+    {
+        evictOldest();
+    }
+    const double oldest_allowed = record.timestamp() - _max_age;
+    while( _size > 0 && _ring[_head].timestamp() < oldest_allowed )
+    {
+        evictOldest();
+    }
+    const uint64_t seq = endSequence();
+    if( seq % _keyframe_interval == 0 )
+    {
+        // assign() reuses the memory of the evicted keyframe
+        Keyframe& keyframe = _keyframes[ (seq / _keyframe_interval) % _keyframes.size() ];
+        keyframe.seq = seq;
+        keyframe.valid = true;
+        keyframe.status.assign( _current_status.begin(), _current_status.end() );
+        keyframe.prev_status.assign( _current_prev.begin(), _current_prev.end() );
+    }
+    if( record.index < _current_status.size() )
+    {
+        _current_prev[record.index]   = static_cast<NodeStatus>(record.prev_status);
+        _current_status[record.index] = static_cast<NodeStatus>(record.status);
+    }
+
+    _ring[ (_head + _size) % _ring.size() ] = record;
+    _size++;
+}
+
+const MonitorRecord& MonitorHistory::at(uint64_t seq) const
+{
+    if( seq < _first_seq || seq >= endSequence() )
+    {
+        throw std::out_of_range("MonitorHistory: record not available");
+    }
+    return _ring[ (_head + (seq - _first_seq)) % _ring.size() ];
+}
+
+const MonitorHistory::Keyframe* MonitorHistory::findKeyframe(uint64_t seq) const
+{
+    const Keyframe& keyframe = _keyframes[ (seq / _keyframe_interval) % _keyframes.size() ];
+    if( keyframe.valid && keyframe.seq == seq && seq >= _first_seq )
+    {
+        return &keyframe;
+    }
+    return nullptr;
+}
+
+uint64_t MonitorHistory::keyframeBefore(uint64_t seq) const
+{
+    seq = std::min( std::max( seq, _first_seq ), endSequence() );
+    const uint64_t keyframe_seq = seq - (seq % _keyframe_interval);
+    return findKeyframe( keyframe_seq ) ? keyframe_seq : _first_seq;
+}
+
+void MonitorHistory::stateAt(uint64_t seq, std::vector<NodeStatus>& status,
+                             std::vector<NodeStatus>& prev_status) const
+{
+    seq = std::min( std::max( seq, _first_seq ), endSequence() );
+
+    const uint64_t start = keyframeBefore( seq );
+    if( const Keyframe* keyframe = findKeyframe( start ) )
+    {
+        status = keyframe->status;
+        prev_status = keyframe->prev_status;
+    }
+    else{
+        status = _baseline_status;
+        prev_status = _baseline_prev;
+    }
+
+    for (uint64_t s = start; s < seq; s++)
+    {
+        const MonitorRecord& record = _ring[ (_head + (s - _first_seq)) % _ring.size() ];
+        if( record.index < status.size() )
+        {
+            prev_status[record.index] = static_cast<NodeStatus>(record.prev_status);
+            status[record.index]      = static_cast<NodeStatus>(record.status);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef MONITOR_HISTORY_H
+#define MONITOR_HISTORY_H
+
+#include <vector>
+#include <cstdint>
+#include "bt_editor_base.h"
+
+// Compact transition record (12 bytes), the same layout as a transition in a .fbl
+// file, with the index of the node in the tree instead of its UID.
+struct MonitorRecord
+{
+    uint32_t sec;
+    uint32_t usec;
+    uint16_t index;
+    uint8_t  prev_status;
+    uint8_t  status;
+
+    double timestamp() const { return sec + usec * 0.000001; }
+};
+
+// Default size of the history: 12 MB of records, about 100 s at 10 kHz or the
+// last 5 minutes, whichever is shorter.
+const size_t MONITOR_HISTORY_CAPACITY = 1024*1024;
+const double MONITOR_HISTORY_MAX_AGE  = 300.0;
+
+// Ring buffer with the most recent transitions received in monitor mode.
+// Memory is allocated once; when a record is evicted (buffer full or too old),
+// it is folded into a baseline, so that the status of the tree at any point of
+// the history can be reconstructed.
+//
+// Every keyframe_interval records the whole status of the tree is stored in a
+// keyframe: stateAt() replays at most keyframe_interval records, whatever the
+// length of the history.
+//
+// Records are identified by a sequence number that keeps growing while the
+// oldest ones are evicted.
+class MonitorHistory
+{
+public:
+    explicit MonitorHistory(size_t capacity = MONITOR_HISTORY_CAPACITY,
+                            double max_age = MONITOR_HISTORY_MAX_AGE,
+                            size_t keyframe_interval = 4096);
+
+    // to be called when a new tree is loaded, with the current status of its nodes
+    void reset(const std::vector<NodeStatus>& initial_status);
+
+    void push(const MonitorRecord& record);
+
+    size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    // sequence number of the oldest record
+    uint64_t firstSequence() const { return _first_seq; }
+
+    // sequence number that the next record will have
+    uint64_t endSequence() const { return _first_seq + _size; }
+
+    const MonitorRecord& at(uint64_t seq) const;
+
+    // Status of the nodes after the records in [firstSequence, seq) were applied.
+    // prev_status contains the previous status of each node, for the styling.
+    void stateAt(uint64_t seq, std::vector<NodeStatus>& status,
+                 std::vector<NodeStatus>& prev_status) const;
+
+    // sequence number of the newest keyframe not after seq, or firstSequence()
+    // when the replay starts from the baseline
+    uint64_t keyframeBefore(uint64_t seq) const;
+
+private:
+    void evictOldest();
+
+    // status of the nodes after the records in [firstSequence, seq)
+    struct Keyframe
+    {
+        uint64_t seq;
+        bool valid;
+        std::vector<NodeStatus> status;
+        std::vector<NodeStatus> prev_status;
+    };
+
+    // keyframe of sequence seq, if it is still in the history
+    const Keyframe* findKeyframe(uint64_t seq) const;
+
+    std::vector<MonitorRecord> _ring;
+    size_t _head;
+    size_t _size;
+    uint64_t _first_seq;
+    double _max_age;
+
+    std::vector<NodeStatus> _baseline_status;
+    std::vector<NodeStatus> _baseline_prev;
+
+    // status after the newest record
+    std::vector<NodeStatus> _current_status;
+    std::vector<NodeStatus> _current_prev;
+
+    // ring indexed by seq / interval: enough slots to cover the whole _ring
+    size_t _keyframe_interval;
+    std::vector<Keyframe> _keyframes;
+};
+
+#endif // MONITOR_HISTORY_H
@@ -0,0 +1,221 @@
+#include "monitor_protocol.h"
+#include "utils.h"
+#include <cstring>
+
+bool RequestTreeFromServer(zmq::context_t& context,
+                           const std::string& address_req,
+                           int timeout_ms,
+                           zmq::message_t& reply)
+{
+    zmq::message_t request(0);
+
+    zmq::socket_t  zmq_client( context, ZMQ_REQ );
+    zmq_client.connect( address_req.c_str() );
+
+    int linger_ms = 0;
+    zmq_client.setsockopt(ZMQ_RCVTIMEO, &timeout_ms, sizeof(int) );
+    zmq_client.setsockopt(ZMQ_LINGER, &linger_ms, sizeof(int) );
+
+    zmq_client.send(request);
+
+    if( !zmq_client.recv(&reply) )
+    {
+        return false;
+    }
+
+    flatbuffers::Verifier verifier( reinterpret_cast<const uint8_t*>(reply.data()),
+                                    reply.size() );
+    return Serialization::VerifyBehaviorTreeBuffer(verifier);
+}
+
+bool ParseStatusMessage(const char* buffer, size_t size,
+                        uint32_t& header_size, uint32_t& num_transitions)
+{
+    if( size < 8 )
+    {
+        return false;
+    }
+    header_size = flatbuffers::ReadScalar<uint32_t>( buffer );
+    if( StatusMessageTransitionsOffset(header_size) > size )
+    {
+        return false;
+    }
+    num_transitions = flatbuffers::ReadScalar<uint32_t>( &buffer[4+header_size] );
+
+    const size_t expected = StatusMessageTransitionsOffset(header_size) +
+                            MONITOR_TRANSITION_SIZE * size_t(num_transitions);
+    return expected <= size;
+}
+
+std::vector<uint16_t> TreeNodesUID(const Serialization::BehaviorTree* fb_behavior_tree)
+{
+    std::vector<uint16_t> uids;
+    uids.reserve( fb_behavior_tree->nodes()->size() );
+    for( const Serialization::TreeNode* fb_node: *(fb_behavior_tree->nodes()) )
+    {
+        uids.push_back( fb_node->uid() );
+    }
+    return uids;
+}
+
+bool StatusHeaderMatches(const char* buffer, uint32_t header_size,
+                         const std::vector<uint16_t>& uids)
+{
+    if( header_size != 3 * uids.size() )
+    {
+        return false;
+    }
+    for (size_t i = 0; i < uids.size(); i++)
+    {
+        if( flatbuffers::ReadScalar<uint16_t>( &buffer[ 4 + 3*i ] ) != uids[i] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+inline void HashBytes(uint64_t& hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+}
+
+inline void HashString(uint64_t& hash, const flatbuffers::String* str)
+{
+    const uint32_t size = str ? str->size() : 0;
+    HashBytes( hash, &size, sizeof(size) );
+    if( size > 0 )
+    {
+        HashBytes( hash, str->data(), size );
+    }
+}
+
+template <typename T>
+inline void HashScalar(uint64_t& hash, T value)
+{
+    HashBytes( hash, &value, sizeof(T) );
+}
+
+inline bool SameString(const flatbuffers::String* a, const flatbuffers::String* b)
+{
+    const uint32_t size_a = a ? a->size() : 0;
+    const uint32_t size_b = b ? b->size() : 0;
+    return size_a == size_b && ( size_a == 0 || std::memcmp( a->data(), b->data(), size_a ) == 0 );
+}
+
+}
+
+uint64_t TreeStructureHash(const Serialization::BehaviorTree* fb_behavior_tree)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    HashScalar( hash, fb_behavior_tree->root_uid() );
+
+    for( const Serialization::NodeModel* model: *(fb_behavior_tree->node_models()) )
+    {
+        HashString( hash, model->registration_name() );
+        HashScalar( hash, static_cast<int>(model->type()) );
+        for( const Serialization::PortModel* port: *(model->ports()) )
+        {
+            HashString( hash, port->port_name() );
+            HashScalar( hash, static_cast<int>(port->direction()) );
+            HashString( hash, port->type_info() );
+            HashString( hash, port->description() );
+        }
+    }
+
+    for( const Serialization::TreeNode* fb_node: *(fb_behavior_tree->nodes()) )
+    {
+        HashScalar( hash, fb_node->uid() );
+        HashString( hash, fb_node->instance_name() );
+        HashString( hash, fb_node->registration_name() );
+
+        HashScalar( hash, fb_node->children_uid()->size() );
+        for( const auto child_uid: *(fb_node->children_uid()) )
+        {
+            HashScalar( hash, child_uid );
+        }
+        for( const Serialization::PortConfig* pair: *(fb_node->port_remaps()) )
+        {
+            HashString( hash, pair->port_name() );
+            HashString( hash, pair->remap() );
+        }
+    }
+    return hash;
+}
+
+bool SameTreeStructure(const Serialization::BehaviorTree* a,
+                       const Serialization::BehaviorTree* b)
+{
+    if( a->root_uid() != b->root_uid() ||
+        a->node_models()->size() != b->node_models()->size() ||
+        a->nodes()->size() != b->nodes()->size() )
+    {
+        return false;
+    }
+
+    for( flatbuffers::uoffset_t i = 0; i < a->node_models()->size(); i++ )
+    {
+        const Serialization::NodeModel* model_a = a->node_models()->Get(i);
+        const Serialization::NodeModel* model_b = b->node_models()->Get(i);
+        if( !SameString( model_a->registration_name(), model_b->registration_name() ) ||
+            model_a->type() != model_b->type() ||
+            model_a->ports()->size() != model_b->ports()->size() )
+        {
+            return false;
+        }
+        for( flatbuffers::uoffset_t p = 0; p < model_a->ports()->size(); p++ )
+        {
+            const Serialization::PortModel* port_a = model_a->ports()->Get(p);
+            const Serialization::PortModel* port_b = model_b->ports()->Get(p);
+            if( !SameString( port_a->port_name(), port_b->port_name() ) ||
+                port_a->direction() != port_b->direction() ||
+                !SameString( port_a->type_info(), port_b->type_info() ) ||
+                !SameString( port_a->description(), port_b->description() ) )
+            {
+                return false;
+            }
+        }
+    }
+
+    for( flatbuffers::uoffset_t i = 0; i < a->nodes()->size(); i++ )
+    {
+        const Serialization::TreeNode* node_a = a->nodes()->Get(i);
+        const Serialization::TreeNode* node_b = b->nodes()->Get(i);
+        if( node_a->uid() != node_b->uid() ||
+            !SameString( node_a->instance_name(), node_b->instance_name() ) ||
+            !SameString( node_a->registration_name(), node_b->registration_name() ) ||
+            node_a->children_uid()->size() != node_b->children_uid()->size() ||
+            node_a->port_remaps()->size() != node_b->port_remaps()->size() )
+        {
+            return false;
+        }
+        for( flatbuffers::uoffset_t c = 0; c < node_a->children_uid()->size(); c++ )
+        {
+            if( node_a->children_uid()->Get(c) != node_b->children_uid()->Get(c) )
+            {
+                return false;
+            }
+        }
+        for( flatbuffers::uoffset_t p = 0; p < node_a->port_remaps()->size(); p++ )
+        {
+            const Serialization::PortConfig* pair_a = node_a->port_remaps()->Get(p);
+            const Serialization::PortConfig* pair_b = node_b->port_remaps()->Get(p);
+            if( !SameString( pair_a->port_name(), pair_b->port_name() ) ||
+                !SameString( pair_a->remap(), pair_b->remap() ) )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef MONITOR_PROTOCOL_H
+#define MONITOR_PROTOCOL_H
+
+#include <string>
+#include <vector>
+#include <zmq.hpp>
+#include <behaviortree_cpp_v3/flatbuffers/BT_logger_generated.h>
+
+// Protocol of BT::PublisherZMQ, shared by the monitor and the recorder.
+//
+// The REQ/REP server returns the flatbuffers of the tree (Serialization::BehaviorTree).
+// Each message of the PUB socket is:
+//
+//   uint32 header_size
+//   header_size bytes: current state of the tree, 3 bytes per node (uint16 uid, uint8 status)
+//   uint32 num_transitions
+//   num_transitions * 12 bytes: same format of the transitions in a .fbl file
+//       (uint32 sec, uint32 usec, uint16 uid, uint8 prev_status, uint8 status)
+
+const size_t MONITOR_TRANSITION_SIZE = 12;
+
+// Ask the tree to the server. Returns false on timeout or if the reply is
+// not a valid Serialization::BehaviorTree. Throws zmq::error_t.
+bool RequestTreeFromServer(zmq::context_t& context,
+                           const std::string& address_req,
+                           int timeout_ms,
+                           zmq::message_t& reply);
+
+// Validates the layout of a message of the PUB socket.
+// Returns false if the message is truncated.
+bool ParseStatusMessage(const char* buffer, size_t size,
+                        uint32_t& header_size, uint32_t& num_transitions);
+
+// Hash (FNV-1a) of the structure of a tree received from the server: nodes, models,
+// children and port remapping. The status of the nodes is not included.
+uint64_t TreeStructureHash(const Serialization::BehaviorTree* fb_behavior_tree);
+
+// True if the two trees have the same structure: the fields of TreeStructureHash(),
+// compared one by one. The status of the nodes is ignored.
+bool SameTreeStructure(const Serialization::BehaviorTree* a,
+                       const Serialization::BehaviorTree* b);
+
+// UIDs of the nodes of the tree, in the order of the header of the status messages
+std::vector<uint16_t> TreeNodesUID(const Serialization::BehaviorTree* fb_behavior_tree);
+
+// True if the header of a status message lists exactly these UIDs, in the same order:
+// the message refers to the tree of these UIDs. The size of the header must be valid.
+bool StatusHeaderMatches(const char* buffer, uint32_t header_size,
+                         const std::vector<uint16_t>& uids);
+
+// Offset of the first transition in a message
+inline size_t StatusMessageTransitionsOffset(uint32_t header_size)
+{
+    return 8 + header_size;
+}
+
+#endif // MONITOR_PROTOCOL_H
@@ -0,0 +1,145 @@
+#include "monitor_publisher.h"
+#include <QDebug>
+#include <cstring>
+
+#include "monitor_protocol.h"
+
+namespace {
+std::string LastEndpoint(zmq::socket_t& socket)
+{
+    char endpoint[256];
+    size_t size = sizeof(endpoint);
+    socket.getsockopt( ZMQ_LAST_ENDPOINT, endpoint, &size );
+    return std::string( endpoint );
+}
+}
+
+MonitorPublisher::MonitorPublisher(zmq::context_t& context,
+                                   const std::string& address_pub,
+                                   const std::string& address_rep):
+    _publisher( context, ZMQ_PUB ),
+    _server( context, ZMQ_REP ),
+    _running(true),
+    _published(0),
+    _requests(0)
+{
+    int linger_ms = 0;
+    int timeout_ms = 100;
+    _publisher.setsockopt(ZMQ_LINGER, &linger_ms, sizeof(int) );
+    _server.setsockopt(ZMQ_LINGER, &linger_ms, sizeof(int) );
+    _server.setsockopt(ZMQ_RCVTIMEO, &timeout_ms, sizeof(int) );
+
+    _publisher.bind( address_pub.c_str() );
+    _server.bind( address_rep.c_str() );
+    _endpoint_pub = LastEndpoint( _publisher );
+    _endpoint_rep = LastEndpoint( _server );
+
+    _server_thread = std::thread( &MonitorPublisher::serverLoop, this );
+}
+
+MonitorPublisher::~MonitorPublisher()
+{
+    _running = false;
+    _server_thread.join();
+}
+
+void MonitorPublisher::addSharedMemory(const std::string& shm_name, size_t capacity)
+{
+    _shm.reset( new ShmStatusWriter( shm_name, capacity ) );
+}
+
+void MonitorPublisher::setTree(const std::string& tree_buffer)
+{
+    std::lock_guard<std::mutex> lock( _tree_mutex );
+    _tree_buffer = tree_buffer;
+    _uids.clear();
+    _uid_position.clear();
+
+    auto fb_behavior_tree = Serialization::GetBehaviorTree( _tree_buffer.data() );
+    for( const Serialization::TreeNode* fb_node: *(fb_behavior_tree->nodes()) )
+    {
+        const uint16_t uid = fb_node->uid();
+        if( uid >= _uid_position.size() )
+        {
+            _uid_position.resize( uid + 1, -1 );
+        }
+        _uid_position[uid] = static_cast<int>( _uids.size() );
+        _uids.push_back( uid );
+    }
+    _status.assign( _uids.size(), static_cast<uint8_t>(Serialization::NodeStatus::IDLE) );
+}
+
+std::vector<uint16_t> MonitorPublisher::uids() const
+{
+    std::lock_guard<std::mutex> lock( _tree_mutex );
+    return _uids;
+}
+
+void MonitorPublisher::publish(const char* transitions, size_t count)
+{
+    {
+        std::lock_guard<std::mutex> lock( _tree_mutex );
+
+        // the header contains the state after the transitions
+        for (size_t t = 0; t < count; t++)
+        {
+            const char* ptr = &transitions[ MONITOR_TRANSITION_SIZE * t ];
+            uint16_t uid;
+            std::memcpy( &uid, &ptr[8], sizeof(uid) );
+            if( uid < _uid_position.size() && _uid_position[uid] >= 0 )
+            {
+                _status[ _uid_position[uid] ] = static_cast<uint8_t>( ptr[11] );
+            }
+        }
+
+        const uint32_t header_size = 3 * _uids.size();
+        const uint32_t num_transitions = count;
+
+        _message.clear();
+        _message.append( reinterpret_cast<const char*>(&header_size), 4 );
+        for (size_t i = 0; i < _uids.size(); i++)
+        {
+            _message.append( reinterpret_cast<const char*>(&_uids[i]), 2 );
+            _message.push_back( static_cast<char>(_status[i]) );
+        }
+        _message.append( reinterpret_cast<const char*>(&num_transitions), 4 );
+        _message.append( transitions, MONITOR_TRANSITION_SIZE * count );
+    }
+
+    if( _shm )
+    {
+        _shm->write( _message.data(), _message.size() );
+    }
+
+    zmq::message_t msg( _message.size() );
+    std::memcpy( msg.data(), _message.data(), _message.size() );
+    _publisher.send( msg );
+    _published++;
+}
+
+void MonitorPublisher::serverLoop()
+{
+    try{
+        zmq::message_t request;
+        while( _running )
+        {
+            if( !_server.recv( &request ) )
+            {
+                continue;
+            }
+            std::string tree_buffer;
+            {
+                std::lock_guard<std::mutex> lock( _tree_mutex );
+                tree_buffer = _tree_buffer;
+            }
+            zmq::message_t reply( tree_buffer.size() );
+            std::memcpy( reply.data(), tree_buffer.data(), tree_buffer.size() );
+            _server.send( reply );
+            _requests++;
+        }
+    }
+    catch( zmq::error_t& err)
+    {
+        qDebug() << "MonitorPublisher server failed: " << err.what();
+    }
+}
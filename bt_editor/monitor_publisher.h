@@ -0,0 +1,76 @@
+#ifndef MONITOR_PUBLISHER_H
+#define MONITOR_PUBLISHER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+
+#include "shm_ring.h"
+
+// Stand-in for BT::PublisherZMQ, to test the monitor without a robot.
+// The tree is served on a REP socket (by a thread) and the status messages are
+// published with the format described in monitor_protocol.h.
+class MonitorPublisher
+{
+public:
+    // Binds both sockets, for instance "tcp://*:1666", or "tcp://127.0.0.1:*" to
+    // let the system choose a free port. Throws zmq::error_t.
+    MonitorPublisher(zmq::context_t& context,
+                     const std::string& address_pub,
+                     const std::string& address_rep);
+
+    ~MonitorPublisher();
+
+    // Also writes the messages into the shared memory segment shm_name
+    // (see shm_ring.h), for monitors on the same host. Throws std::runtime_error.
+    void addSharedMemory(const std::string& shm_name, size_t capacity = 4*1024*1024);
+
+    // tree_buffer is a Serialization::BehaviorTree, the same stored in a .fbl file.
+    // All the nodes start IDLE.
+    void setTree(const std::string& tree_buffer);
+
+    // Publishes a single message with the current state of the tree and the
+    // given transitions (12 bytes each, the format of a .fbl file).
+    // Not thread-safe: call it always from the same thread.
+    void publish(const char* transitions, size_t count);
+
+    uint64_t publishedCount() const { return _published; }
+
+    // how many times the tree was requested
+    uint64_t requestsCount() const { return _requests; }
+
+    // UIDs of the tree, in the order of the header of the messages
+    std::vector<uint16_t> uids() const;
+
+    // the addresses actually bound, with the port chosen by the system
+    const std::string& endpointPublisher() const { return _endpoint_pub; }
+    const std::string& endpointServer() const { return _endpoint_rep; }
+
+private:
+    void serverLoop();
+
+    zmq::socket_t _publisher;
+    zmq::socket_t _server;
+    std::string _endpoint_pub;
+    std::string _endpoint_rep;
+    std::unique_ptr<ShmStatusWriter> _shm;
+    std::thread _server_thread;
+    std::atomic<bool> _running;
+    std::atomic<uint64_t> _published;
+    std::atomic<uint64_t> _requests;
+
+    mutable std::mutex _tree_mutex;
+    std::string _tree_buffer;
+    std::vector<uint16_t> _uids;
+    // position in _uids, indexed by UID
+    std::vector<int> _uid_position;
+    std::vector<uint8_t> _status;
+
+    std::string _message;
+};
+
+#endif // MONITOR_PUBLISHER_H
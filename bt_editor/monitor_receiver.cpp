@@ -0,0 +1,432 @@
+#include "monitor_receiver.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#include "utils.h"
+#include "shm_ring.h"
+
+namespace {
+// upper bound of the messages read from a socket before the others are served
+const int MAX_MESSAGES_PER_POLL = 256;
+// shared memory: rounds without messages before sleeping between reads
+const int SHM_SPIN_ROUNDS = 1000;
+// shared memory: longest wait on the futex of the ring, to check the commands
+const int SHM_WAIT_TIMEOUT_US = 50000;
+// shared memory: period of the checks for a segment which is missing or replaced
+const auto SHM_REOPEN_PERIOD = std::chrono::milliseconds(500);
+
+bool IsSharedMemory(const std::string& address)
+{
+    return address.compare( 0, strlen(MONITOR_SHM_SCHEME), MONITOR_SHM_SCHEME ) == 0;
+}
+}
+
+MonitorReceiver::MonitorReceiver(zmq::context_t& context):
+    _zmq_context(context),
+    _running(false),
+    _queue(1024)
+{
+}
+
+MonitorReceiver::~MonitorReceiver()
+{
+    stop();
+}
+
+void MonitorReceiver::addConnection(int connection_id, const std::string& address_pub,
+                                    const MonitorPolicy& policy)
+{
+    {
+        std::lock_guard<std::mutex> lock( _commands_mutex );
+        _commands.push_back( {true, connection_id, address_pub, policy} );
+    }
+    {
+        std::lock_guard<std::mutex> lock( _uid_mutex );
+        _trees[connection_id];
+    }
+    if( !_thread.joinable() )
+    {
+        _counters.reset();
+        _running = true;
+        _thread = std::thread( &MonitorReceiver::loop, this );
+    }
+}
+
+void MonitorReceiver::removeConnection(int connection_id)
+{
+    {
+        std::lock_guard<std::mutex> lock( _commands_mutex );
+        _commands.push_back( {false, connection_id, std::string(), MonitorPolicy()} );
+    }
+    std::lock_guard<std::mutex> lock( _uid_mutex );
+    _trees.erase( connection_id );
+}
+
+void MonitorReceiver::stop()
+{
+    _running = false;
+    if( _thread.joinable() )
+    {
+        _thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock( _commands_mutex );
+        _commands.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock( _uid_mutex );
+        _trees.clear();
+    }
+    // drop whatever is left
+    MonitorStatusBatch old_batch;
+    while( _queue.pop(old_batch) ) {}
+}
+
+void MonitorReceiver::setTree(int connection_id, const std::unordered_map<int, int>& uid_to_index)
+{
+    std::lock_guard<std::mutex> lock( _uid_mutex );
+    auto it = _trees.find( connection_id );
+    if( it != _trees.end() )
+    {
+        it->second.decoder.setTree( uid_to_index );
+        it->second.waiting_tree = false;
+    }
+}
+
+void MonitorReceiver::loop()
+{
+    struct Subscription
+    {
+        int connection_id;
+        MonitorPolicy policy;
+        std::unique_ptr<zmq::socket_t> socket;
+        // SAMPLE: latest message received, processed at the next sample
+        zmq::message_t pending;
+        bool has_pending;
+        std::chrono::steady_clock::time_point next_sample;
+        // shared memory, instead of the socket
+        std::unique_ptr<ShmStatusReader> shm;
+        std::string shm_name;
+        std::chrono::steady_clock::time_point next_shm_check;
+        // LOSSLESS: decoded batch that didn't fit in the queue. Nothing else is
+        // read from this connection until it is pushed; the others are still served
+        MonitorStatusBatch blocked_batch;
+        bool blocked;
+    };
+    std::vector<std::unique_ptr<Subscription>> subscriptions;
+    // the subscriptions with a socket, in the same order of poll_items
+    std::vector<Subscription*> polled;
+    std::vector<zmq::pollitem_t> poll_items;
+    bool has_shm = false;
+    // the only subscription, if it is a ring that can be waited on
+    Subscription* waitable_shm = nullptr;
+    int shm_idle_rounds = 0;
+
+    try{
+        zmq::message_t msg;
+        std::string shm_msg;
+        std::string shm_latest;
+        // swapped with the slots of the queue: its vectors are reused
+        MonitorStatusBatch batch;
+        while( _running )
+        {
+            std::vector<Command> commands;
+            {
+                std::lock_guard<std::mutex> lock( _commands_mutex );
+                commands.swap( _commands );
+            }
+            for (const auto& command: commands)
+            {
+                if( command.add )
+                {
+                    std::unique_ptr<Subscription> sub( new Subscription );
+                    sub->connection_id = command.connection_id;
+                    sub->policy = command.policy;
+                    sub->has_pending = false;
+                    sub->blocked = false;
+                    sub->next_sample = std::chrono::steady_clock::now();
+                    if( IsSharedMemory( command.address_pub ) )
+                    {
+                        // opened by the loop below, the segment might not exist yet
+                        sub->shm.reset( new ShmStatusReader );
+                        sub->shm_name = command.address_pub.substr( strlen(MONITOR_SHM_SCHEME) );
+                        sub->next_shm_check = sub->next_sample;
+                        subscriptions.push_back( std::move(sub) );
+                        continue;
+                    }
+                    sub->socket.reset( new zmq::socket_t( _zmq_context, ZMQ_SUB ) );
+                    int linger_ms = 0;
+                    sub->socket->setsockopt(ZMQ_SUBSCRIBE, "", 0);
+                    sub->socket->setsockopt(ZMQ_LINGER, &linger_ms, sizeof(int) );
+                    if( command.policy.mode == MonitorPolicy::LOSSLESS )
+                    {
+                        int unlimited = 0;
+                        sub->socket->setsockopt(ZMQ_RCVHWM, &unlimited, sizeof(int) );
+                    }
+                    else if( command.policy.mode == MonitorPolicy::CONFLATE )
+                    {
+                        int conflate = 1;
+                        sub->socket->setsockopt(ZMQ_CONFLATE, &conflate, sizeof(int) );
+                    }
+                    sub->socket->connect( command.address_pub.c_str() );
+                    subscriptions.push_back( std::move(sub) );
+                }
+                else{
+                    for (auto it = subscriptions.begin(); it != subscriptions.end(); it++)
+                    {
+                        if( (*it)->connection_id == command.connection_id )
+                        {
+                            subscriptions.erase( it );
+                            break;
+                        }
+                    }
+                }
+            }
+            if( !commands.empty() )
+            {
+                polled.clear();
+                poll_items.clear();
+                has_shm = false;
+                waitable_shm = nullptr;
+                if( subscriptions.size() == 1 && subscriptions.front()->shm &&
+                    subscriptions.front()->policy.mode != MonitorPolicy::SAMPLE )
+                {
+                    waitable_shm = subscriptions.front().get();
+                }
+                for (auto& sub: subscriptions)
+                {
+                    if( sub->shm )
+                    {
+                        has_shm = true;
+                        continue;
+                    }
+                    polled.push_back( sub.get() );
+                    poll_items.push_back( { static_cast<void*>(*sub->socket), 0, ZMQ_POLLIN, 0 } );
+                }
+            }
+
+            if( subscriptions.empty() )
+            {
+                std::this_thread::sleep_for( std::chrono::milliseconds(50) );
+                continue;
+            }
+
+            // the GUI is late with the LOSSLESS connections: their messages wait,
+            // buffered by ZMQ (or by the ring, until it is overrun), instead of being
+            // dropped. The socket of a blocked connection is not polled meanwhile
+            bool any_blocked = false;
+            for (auto& sub: subscriptions)
+            {
+                if( sub->blocked && _queue.exchangePush( sub->blocked_batch ) )
+                {
+                    sub->blocked = false;
+                }
+                any_blocked = any_blocked || sub->blocked;
+            }
+            for (size_t i = 0; i < poll_items.size(); i++)
+            {
+                poll_items[i].events = polled[i]->blocked ? 0 : ZMQ_POLLIN;
+            }
+
+            // short timeout, to check _running and the commands periodically.
+            // Shared memory is read right after a message; when idle, a single ring
+            // is waited on its futex, otherwise it is read every millisecond.
+            // The push of a blocked batch is retried every millisecond too.
+            int timeout_ms = 50;
+            if( has_shm )
+            {
+                timeout_ms = ( shm_idle_rounds < SHM_SPIN_ROUNDS ) ? 0 : 1;
+            }
+            if( any_blocked )
+            {
+                timeout_ms = std::min( timeout_ms, 1 );
+            }
+            if( !poll_items.empty() )
+            {
+                zmq::poll( poll_items.data(), poll_items.size(), timeout_ms );
+            }
+            else if( timeout_ms > 0 && waitable_shm && !waitable_shm->blocked &&
+                     waitable_shm->shm->isOpen() )
+            {
+                waitable_shm->shm->wait( SHM_WAIT_TIMEOUT_US );
+            }
+            else if( timeout_ms > 0 )
+            {
+                std::this_thread::sleep_for( std::chrono::milliseconds(timeout_ms) );
+            }
+            else{
+                std::this_thread::yield();
+            }
+
+            for (size_t i = 0; i < poll_items.size() && _running; i++)
+            {
+                Subscription& sub = *polled[i];
+                if( poll_items[i].revents & ZMQ_POLLIN )
+                {
+                    for (int count = 0; count < MAX_MESSAGES_PER_POLL && !sub.blocked; count++)
+                    {
+                        if( !sub.socket->recv(&msg, ZMQ_DONTWAIT) )
+                        {
+                            break;
+                        }
+                        _counters.messages.fetch_add( 1, std::memory_order_relaxed );
+                        _counters.bytes.fetch_add( msg.size(), std::memory_order_relaxed );
+
+                        if( sub.policy.mode == MonitorPolicy::SAMPLE )
+                        {
+                            // not decoded: only the latest one will be
+                            if( sub.has_pending )
+                            {
+                                _counters.dropped.fetch_add( 1, std::memory_order_relaxed );
+                            }
+                            sub.pending.move( &msg );
+                            sub.has_pending = true;
+                        }
+                        else if( !process( sub.connection_id, sub.policy,
+                                           static_cast<const char*>(msg.data()), msg.size(), batch ) )
+                        {
+                            std::swap( batch, sub.blocked_batch );
+                            sub.blocked = true;
+                        }
+                    }
+                }
+            }
+
+            bool shm_received = false;
+            const auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < subscriptions.size() && _running; i++)
+            {
+                Subscription& sub = *subscriptions[i];
+                if( sub.has_pending && now >= sub.next_sample )
+                {
+                    process( sub.connection_id, sub.policy, static_cast<const char*>(sub.pending.data()),
+                             sub.pending.size(), batch );
+                    sub.has_pending = false;
+                    sub.next_sample = now + std::chrono::microseconds(
+                                          static_cast<int64_t>( 1e6 / std::max( 0.1, sub.policy.sample_rate ) ) );
+                }
+                if( !sub.shm )
+                {
+                    continue;
+                }
+
+                if( now >= sub.next_shm_check &&
+                    ( !sub.shm->isOpen() || shm_idle_rounds >= SHM_SPIN_ROUNDS ) )
+                {
+                    sub.next_shm_check = now + SHM_REOPEN_PERIOD;
+                    if( !sub.shm->isOpen() || sub.shm->replaced() )
+                    {
+                        sub.shm->open( sub.shm_name );
+                    }
+                }
+                // SAMPLE doesn't read the ring between two samples; the writer
+                // might overrun it meanwhile, which is handled as any other gap
+                if( sub.blocked ||
+                    ( sub.policy.mode == MonitorPolicy::SAMPLE && now < sub.next_sample ) )
+                {
+                    continue;
+                }
+
+                const uint64_t overruns = sub.shm->overrunsCount();
+                bool has_latest = false;
+                for (int count = 0; count < MAX_MESSAGES_PER_POLL && !sub.blocked; count++)
+                {
+                    if( !sub.shm->read( shm_msg ) )
+                    {
+                        break;
+                    }
+                    shm_received = true;
+                    _counters.messages.fetch_add( 1, std::memory_order_relaxed );
+                    _counters.bytes.fetch_add( shm_msg.size(), std::memory_order_relaxed );
+
+                    if( sub.policy.mode == MonitorPolicy::LOSSLESS )
+                    {
+                        if( !process( sub.connection_id, sub.policy, shm_msg.data(), shm_msg.size(), batch ) )
+                        {
+                            std::swap( batch, sub.blocked_batch );
+                            sub.blocked = true;
+                        }
+                        continue;
+                    }
+                    // CONFLATE and SAMPLE: only the latest one is decoded
+                    if( has_latest )
+                    {
+                        _counters.dropped.fetch_add( 1, std::memory_order_relaxed );
+                    }
+                    shm_latest.swap( shm_msg );
+                    has_latest = true;
+                }
+                // the messages lost in an overrun are unknown: at least one each
+                _counters.dropped.fetch_add( sub.shm->overrunsCount() - overruns, std::memory_order_relaxed );
+
+                if( has_latest )
+                {
+                    process( sub.connection_id, sub.policy, shm_latest.data(), shm_latest.size(), batch );
+                    sub.next_sample = now + std::chrono::microseconds(
+                                          static_cast<int64_t>( 1e6 / std::max( 0.1, sub.policy.sample_rate ) ) );
+                }
+            }
+            shm_idle_rounds = shm_received ? 0 : std::min( shm_idle_rounds + 1, SHM_SPIN_ROUNDS );
+        }
+    }
+    catch( zmq::error_t& err)
+    {
+        qDebug() << "ZMQ receive failed: " << err.what();
+    }
+}
+
+bool MonitorReceiver::process(int connection_id, const MonitorPolicy& policy,
+                              const char* data, size_t size, MonitorStatusBatch& batch)
+{
+    const auto decode_start = std::chrono::steady_clock::now();
+    const bool decoded = decode( connection_id, data, size, batch );
+    const auto decode_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - decode_start ).count();
+    _counters.decode_ns.fetch_add( decode_ns, std::memory_order_relaxed );
+
+    if( !decoded )
+    {
+        _counters.dropped.fetch_add( 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    if( policy.mode == MonitorPolicy::LOSSLESS )
+    {
+        return _queue.exchangePush( batch );
+    }
+    // the GUI is late: the next message will resync it
+    if( !_queue.exchangePush( batch ) )
+    {
+        _counters.dropped.fetch_add( 1, std::memory_order_relaxed );
+    }
+    return true;
+}
+
+bool MonitorReceiver::decode(int connection_id, const char* data, size_t size,
+                             MonitorStatusBatch& batch)
+{
+    batch.connection_id = connection_id;
+    batch.reload_tree = false;
+
+    std::lock_guard<std::mutex> lock( _uid_mutex );
+    auto tree_it = _trees.find( connection_id );
+    if( tree_it == _trees.end() || tree_it->second.waiting_tree )
+    {
+        return false;
+    }
+    TreeIndex& tree = tree_it->second;
+
+    const auto result = tree.decoder.decode( data, size, batch.state, batch.transitions );
+    if( result == StatusMessageDecoder::UNKNOWN_UID )
+    {
+        // the tree must be loaded from server
+        batch.state.clear();
+        batch.transitions.clear();
+        batch.reload_tree = true;
+        tree.waiting_tree = true;
+    }
+    return result != StatusMessageDecoder::MALFORMED;
+}
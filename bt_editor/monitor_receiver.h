@@ -0,0 +1,136 @@
+#ifndef MONITOR_RECEIVER_H
+#define MONITOR_RECEIVER_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <zmq.hpp>
+
+#include "bt_editor_base.h"
+#include "spsc_queue.h"
+#include "monitor_history.h"
+#include "monitor_stats.h"
+#include "status_decoder.h"
+
+// Status changes decoded from a single message of the publisher.
+struct MonitorStatusBatch
+{
+    MonitorStatusBatch(): connection_id(-1), reload_tree(false) {}
+
+    // the connection that received the message
+    int connection_id;
+    // full state of the tree (header of the message)
+    std::vector<std::pair<int, NodeStatus>> state;
+    // transitions, in the order they happened
+    std::vector<MonitorRecord> transitions;
+    // the message contains a UID which is not in the current tree
+    bool reload_tree;
+};
+
+// How a connection deals with a publisher faster than the monitor.
+// The header of every message carries the full state of the tree, so the
+// messages skipped by CONFLATE and SAMPLE are recovered by a resync.
+struct MonitorPolicy
+{
+    enum Mode
+    {
+        LOSSLESS,   // no high water mark: every message is received, whatever the delay
+        CONFLATE,   // ZMQ_CONFLATE: only the latest message is kept
+        SAMPLE      // at most sample_rate messages per second, the others are dropped
+    };
+
+    MonitorPolicy(Mode m = LOSSLESS, double rate = 10.0): mode(m), sample_rate(rate) {}
+
+    Mode mode;
+    double sample_rate;
+};
+
+// Owns the SUB sockets of all the connections in a single thread, that waits on
+// them with zmq_poll. Messages are received and decoded there and the resulting
+// batches, tagged with the id of their connection, are pushed into a lock-free
+// queue; the GUI thread pops them at frame rate.
+//
+// An address in the form shm://<name> reads the messages from the shared memory
+// ring of a publisher on the same host (see shm_ring.h) instead of a SUB socket.
+// Shared memory can't be polled: the thread spins for a while after the last
+// message. Then, if the ring is the only connection (and not SAMPLE), the thread
+// blocks on its futex and wakes up a few microseconds after the next message;
+// otherwise it reads the rings every millisecond, between the polls of the sockets.
+//
+// When the queue is full, a LOSSLESS connection keeps its decoded batch and isn't
+// read any more until the GUI makes room for it; the other connections are still served.
+class MonitorReceiver
+{
+public:
+    explicit MonitorReceiver(zmq::context_t& context);
+    ~MonitorReceiver();
+
+    // the thread is started by the first connection
+    void addConnection(int connection_id, const std::string& address_pub,
+                       const MonitorPolicy& policy = MonitorPolicy());
+
+    void removeConnection(int connection_id);
+
+    // removes all the connections and stops the thread
+    void stop();
+
+    // must be called (from the GUI thread) every time a new tree is loaded
+    void setTree(int connection_id, const std::unordered_map<int, int>& uid_to_index);
+
+    // consumer side, GUI thread only. The previous content of batch is recycled by
+    // the receiver: keep using the same object to avoid allocations.
+    bool pop(MonitorStatusBatch& batch) { return _queue.exchangePop(batch); }
+
+    uint64_t messagesCount() const { return _counters.messages.load( std::memory_order_relaxed ); }
+
+    // reset when the thread is started
+    const MonitorCounters& counters() const { return _counters; }
+
+    // batches waiting for the GUI
+    size_t queueDepth() const { return _queue.size(); }
+
+private:
+    struct TreeIndex
+    {
+        TreeIndex(): waiting_tree(true) {}
+        StatusMessageDecoder decoder;
+        // a reload was requested; messages are dropped until setTree() is called
+        bool waiting_tree;
+    };
+
+    struct Command
+    {
+        bool add;
+        int connection_id;
+        std::string address_pub;
+        MonitorPolicy policy;
+    };
+
+    void loop();
+
+    // Decodes the message and pushes it into the queue. Returns false, with the
+    // decoded batch left in batch, only if the queue of a LOSSLESS connection is full
+    bool process(int connection_id, const MonitorPolicy& policy, const char* data, size_t size,
+                 MonitorStatusBatch& batch);
+
+    // false if the message must be dropped
+    bool decode(int connection_id, const char* data, size_t size, MonitorStatusBatch& batch);
+
+    zmq::context_t& _zmq_context;
+    std::thread _thread;
+    std::atomic<bool> _running;
+    MonitorCounters _counters;
+
+    // sockets are created and closed by the thread itself
+    std::mutex _commands_mutex;
+    std::vector<Command> _commands;
+
+    std::mutex _uid_mutex;
+    std::map<int, TreeIndex> _trees;
+
+    SpscQueue<MonitorStatusBatch> _queue;
+};
+
+#endif // MONITOR_RECEIVER_H
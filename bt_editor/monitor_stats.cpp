@@ -0,0 +1,147 @@
+#include "monitor_stats.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+// one day of samples, at most
+const size_t MAX_SAMPLES = 24*3600;
+}
+
+MonitorStatsAccumulator::MonitorStatsAccumulator(int period_ms):
+    _period_ms(period_ms)
+{
+    reset();
+}
+
+void MonitorStatsAccumulator::reset()
+{
+    _start.start();
+    _period.start();
+    _last_messages = 0;
+    _last_bytes = 0;
+    _last_dropped = 0;
+    _last_decode_ns = 0;
+    _last_coalesced = 0;
+    _latency_sum = 0;
+    _latency_max = 0;
+    _latency_count = 0;
+    _style_sum = 0;
+    _style_max = 0;
+    _style_count = 0;
+    _resyncs = 0;
+    _samples.clear();
+}
+
+void MonitorStatsAccumulator::addLatency(double seconds)
+{
+    _latency_sum += seconds;
+    _latency_max = std::max( _latency_max, seconds );
+    _latency_count++;
+}
+
+void MonitorStatsAccumulator::addStyleTime(double seconds)
+{
+    _style_sum += seconds;
+    _style_max = std::max( _style_max, seconds );
+    _style_count++;
+}
+
+bool MonitorStatsAccumulator::update(const MonitorCounters& counters, size_t queue_depth,
+                                     uint64_t coalesced, MonitorStatsSample& sample)
+{
+    const qint64 elapsed_ms = _period.elapsed();
+    if( elapsed_ms < _period_ms )
+    {
+        return false;
+    }
+    _period.restart();
+
+    const uint64_t messages  = counters.messages.load();
+    const uint64_t bytes     = counters.bytes.load();
+    const uint64_t dropped   = counters.dropped.load();
+    const uint64_t decode_ns = counters.decode_ns.load();
+
+    // the counters of the receiver might have been reset by a new connection
+    auto delta = [](uint64_t current, uint64_t last) -> double
+    {
+        return current >= last ? double(current - last) : double(current);
+    };
+
+    const double period = elapsed_ms * 0.001;
+    const double new_messages = delta( messages, _last_messages );
+
+    sample.time              = _start.elapsed() * 0.001;
+    sample.messages_per_sec  = new_messages / period;
+    sample.bytes_per_sec     = delta( bytes, _last_bytes ) / period;
+    sample.decode_us         = new_messages > 0 ? delta( decode_ns, _last_decode_ns ) * 0.001 / new_messages : 0.0;
+    sample.queue_depth       = queue_depth;
+    sample.dropped_per_sec   = delta( dropped, _last_dropped ) / period;
+    sample.coalesced_per_sec = delta( coalesced, _last_coalesced ) / period;
+    sample.resyncs_per_sec   = _resyncs / period;
+    sample.style_ms_avg      = _style_count > 0 ? 1000.0 * _style_sum / _style_count : 0.0;
+    sample.style_ms_max      = 1000.0 * _style_max;
+    sample.latency_ms_avg    = _latency_count > 0 ? 1000.0 * _latency_sum / _latency_count : 0.0;
+    sample.latency_ms_max    = 1000.0 * _latency_max;
+
+    _last_messages  = messages;
+    _last_bytes     = bytes;
+    _last_dropped   = dropped;
+    _last_decode_ns = decode_ns;
+    _last_coalesced = coalesced;
+    _latency_sum = _latency_max = 0;
+    _latency_count = 0;
+    _style_sum = _style_max = 0;
+    _style_count = 0;
+    _resyncs = 0;
+
+    if( _samples.size() < MAX_SAMPLES )
+    {
+        _samples.push_back( sample );
+    }
+    return true;
+}
+
+bool MonitorStatsAccumulator::exportCSV(const QString& filename) const
+{
+    QFile file( filename );
+    if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+    {
+        return false;
+    }
+    QTextStream out( &file );
+    out << "time,messages_per_sec,bytes_per_sec,decode_us,queue_depth,"
+           "dropped_per_sec,coalesced_per_sec,resyncs_per_sec,style_ms_avg,style_ms_max,"
+           "latency_ms_avg,latency_ms_max\n";
+
+    for (const auto& s: _samples)
+    {
+        out << s.time << "," << s.messages_per_sec << "," << s.bytes_per_sec << ","
+            << s.decode_us << "," << s.queue_depth << ","
+            << s.dropped_per_sec << "," << s.coalesced_per_sec << "," << s.resyncs_per_sec << ","
+            << s.style_ms_avg << "," << s.style_ms_max << ","
+            << s.latency_ms_avg << "," << s.latency_ms_max << "\n";
+    }
+    return true;
+}
+
+QString MonitorStatsAccumulator::toText(const MonitorStatsSample& s)
+{
+    return QString("Messages: %1/s (%2 KB/s)\n"
+                   "Decoding: %3 us/msg\n"
+                   "Queue: %4   Dropped: %5/s\n"
+                   "Coalesced: %6/s   Resyncs: %7/s\n"
+                   "Styling: %8 ms (max %9)\n"
+                   "Latency: %10 ms (max %11)")
+            .arg( s.messages_per_sec, 0, 'f', 0 )
+            .arg( s.bytes_per_sec / 1024.0, 0, 'f', 1 )
+            .arg( s.decode_us, 0, 'f', 1 )
+            .arg( s.queue_depth, 0, 'f', 0 )
+            .arg( s.dropped_per_sec, 0, 'f', 0 )
+            .arg( s.coalesced_per_sec, 0, 'f', 0 )
+            .arg( s.resyncs_per_sec, 0, 'f', 0 )
+            .arg( s.style_ms_avg, 0, 'f', 2 )
+            .arg( s.style_ms_max, 0, 'f', 2 )
+            .arg( s.latency_ms_avg, 0, 'f', 1 )
+            .arg( s.latency_ms_max, 0, 'f', 1 );
+}
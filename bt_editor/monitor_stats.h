@@ -0,0 +1,95 @@
+#ifndef MONITOR_STATS_H
+#define MONITOR_STATS_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+// Cumulative counters, written by the receiver thread
+struct MonitorCounters
+{
+    MonitorCounters() { reset(); }
+
+    void reset()
+    {
+        messages = 0;
+        bytes = 0;
+        dropped = 0;
+        decode_ns = 0;
+    }
+
+    std::atomic<uint64_t> messages;
+    std::atomic<uint64_t> bytes;
+    // malformed messages or received while waiting for the tree
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> decode_ns;
+};
+
+// Statistics of the monitor pipeline over one period (about one second)
+struct MonitorStatsSample
+{
+    double time;               // seconds since the start of the recording
+    double messages_per_sec;
+    double bytes_per_sec;
+    double decode_us;          // average decoding time of a message
+    double queue_depth;        // batches waiting for the GUI
+    double dropped_per_sec;
+    double coalesced_per_sec;  // transitions never painted, because of the coalescing
+    double resyncs_per_sec;    // gaps in the stream, fixed with the full state of a message
+    double style_ms_avg;       // time spent in onChangeNodesStatus, per frame
+    double style_ms_max;
+    double latency_ms_avg;     // now - timestamp of the transition
+    double latency_ms_max;
+};
+
+// Turns the cumulative counters into one sample per period, measured on the GUI thread.
+class MonitorStatsAccumulator
+{
+public:
+    explicit MonitorStatsAccumulator(int period_ms = 1000);
+
+    void reset();
+
+    // latency of a transition, when it reaches the GUI
+    void addLatency(double seconds);
+
+    // time spent restyling the scene
+    void addStyleTime(double seconds);
+
+    void addResync() { _resyncs++; }
+
+    // Returns true (and fills sample) once per period.
+    bool update(const MonitorCounters& counters, size_t queue_depth,
+                uint64_t coalesced, MonitorStatsSample& sample);
+
+    const std::vector<MonitorStatsSample>& samples() const { return _samples; }
+
+    bool exportCSV(const QString& filename) const;
+
+    static QString toText(const MonitorStatsSample& sample);
+
+private:
+    int _period_ms;
+    QElapsedTimer _start;
+    QElapsedTimer _period;
+
+    uint64_t _last_messages;
+    uint64_t _last_bytes;
+    uint64_t _last_dropped;
+    uint64_t _last_decode_ns;
+    uint64_t _last_coalesced;
+
+    double _latency_sum;
+    double _latency_max;
+    uint64_t _latency_count;
+    double _style_sum;
+    double _style_max;
+    uint64_t _style_count;
+    uint64_t _resyncs;
+
+    std::vector<MonitorStatsSample> _samples;
+};
+
+#endif // MONITOR_STATS_H
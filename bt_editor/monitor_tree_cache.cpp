@@ -0,0 +1,45 @@
+#include "monitor_tree_cache.h"
+#include "monitor_protocol.h"
+#include "utils.h"
+#include <algorithm>
+
+MonitorTreeCache::MonitorTreeCache(size_t max_trees):
+    _max_trees( std::max<size_t>(max_trees, 1) ),
+    _next_id(0),
+    _hits(0),
+    _misses(0)
+{
+}
+
+const MonitorTreeCache::Entry& MonitorTreeCache::get(const std::string& tree_buffer)
+{
+    auto fb_behavior_tree = Serialization::GetBehaviorTree( tree_buffer.data() );
+    const uint64_t tree_hash = TreeStructureHash( fb_behavior_tree );
+
+    for (const Entry& entry: _entries)
+    {
+        if( entry.hash == tree_hash &&
+            SameTreeStructure( Serialization::GetBehaviorTree( entry.buffer.data() ),
+                               fb_behavior_tree ) )
+        {
+            _hits++;
+            return entry;
+        }
+    }
+    _misses++;
+
+    auto res_pair = BuildTreeFromFlatbuffers( fb_behavior_tree );
+    Entry entry;
+    entry.id = _next_id++;
+    entry.hash = tree_hash;
+    entry.buffer = tree_buffer;
+    entry.tree = std::move( res_pair.first );
+    entry.uid_to_index = std::move( res_pair.second );
+    _entries.push_back( std::move(entry) );
+
+    if( _entries.size() > _max_trees )
+    {
+        _entries.pop_front();
+    }
+    return _entries.back();
+}
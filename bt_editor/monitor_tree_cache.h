@@ -0,0 +1,52 @@
+#ifndef MONITOR_TREE_CACHE_H
+#define MONITOR_TREE_CACHE_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include "bt_editor_base.h"
+
+// Trees already received from the servers of the monitor mode.
+// BuildTreeFromFlatbuffers and loadBehaviorTree are expensive with large trees:
+// they are skipped when the same tree is received again (typically, after a
+// reconnection). The trees are found by TreeStructureHash(), then the buffer
+// kept in the entry is compared with SameTreeStructure(), so that a collision
+// of the hash is a miss.
+class MonitorTreeCache
+{
+public:
+    struct Entry
+    {
+        // unique, never reused: identifies the tree loaded in a scene
+        uint64_t id;
+        uint64_t hash;
+        std::string buffer;
+        AbsBehaviorTree tree;
+        std::unordered_map<int, int> uid_to_index;
+    };
+
+    explicit MonitorTreeCache(size_t max_trees = 8);
+
+    // Entry of the tree serialized in tree_buffer, built only if missing.
+    // Its nodes have the status of the first buffer received.
+    // The reference is valid until the next call.
+    const Entry& get(const std::string& tree_buffer);
+
+    void clear() { _entries.clear(); }
+
+    size_t size() const { return _entries.size(); }
+
+    uint64_t hitsCount() const { return _hits; }
+
+    uint64_t missesCount() const { return _misses; }
+
+private:
+    size_t _max_trees;
+    uint64_t _next_id;
+    uint64_t _hits;
+    uint64_t _misses;
+    // oldest first
+    std::deque<Entry> _entries;
+};
+
+#endif // MONITOR_TREE_CACHE_H
@@ -0,0 +1,109 @@
+#include "node_statistics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double MIN_DURATION = 1e-6;
+const double BUCKETS_PER_DECADE = 10.0;
+}
+
+DurationHistogram::DurationHistogram():
+    _count(0),
+    _max(0)
+{
+    _buckets.fill(0);
+}
+
+void DurationHistogram::add(double seconds)
+{
+    int bucket = 0;
+    if( seconds > MIN_DURATION )
+    {
+        bucket = static_cast<int>( std::log10( seconds / MIN_DURATION ) * BUCKETS_PER_DECADE );
+        bucket = std::min( bucket, BUCKETS -1 );
+    }
+    _buckets[bucket]++;
+    _count++;
+    _max = std::max( _max, seconds );
+}
+
+double DurationHistogram::percentile(double p) const
+{
+    if( _count == 0 )
+    {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>( 1, static_cast<uint64_t>( std::ceil( p * _count ) ) );
+    uint64_t accumulated = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        accumulated += _buckets[bucket];
+        if( accumulated >= rank )
+        {
+            const double center = MIN_DURATION * std::pow( 10.0, (bucket + 0.5) / BUCKETS_PER_DECADE );
+            return std::min( center, _max );
+        }
+    }
+    return _max;
+}
+
+NodeStatisticsEntry::NodeStatisticsEntry():
+    ticks(0),
+    success_count(0),
+    failure_count(0),
+    longest_running(0),
+    running_since(-1)
+{
+}
+
+double NodeStatisticsEntry::failureRate() const
+{
+    const uint64_t completed = success_count + failure_count;
+    return (completed == 0) ? 0.0 : double(failure_count) / completed;
+}
+
+void NodeStatistics::reset(size_t nodes_count)
+{
+    _nodes.assign( nodes_count, NodeStatisticsEntry() );
+    _transitions_count = 0;
+}
+
+void NodeStatistics::addTransition(size_t index, NodeStatus prev_status,
+                                   NodeStatus status, double timestamp)
+{
+    if( index >= _nodes.size() )
+    {
+        return;
+    }
+    _transitions_count++;
+    auto& node = _nodes[index];
+
+    if( prev_status == NodeStatus::IDLE && status != NodeStatus::IDLE )
+    {
+        node.ticks++;
+    }
+
+    if( status == NodeStatus::SUCCESS )
+    {
+        node.success_count++;
+    }
+    else if( status == NodeStatus::FAILURE )
+    {
+        node.failure_count++;
+    }
+
+    if( status == NodeStatus::RUNNING )
+    {
+        if( node.running_since < 0 )
+        {
+            node.running_since = timestamp;
+        }
+    }
+    else if( node.running_since >= 0 )
+    {
+        const double duration = timestamp - node.running_since;
+        node.running_durations.add( duration );
+        node.longest_running = std::max( node.longest_running, duration );
+        node.running_since = -1;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef NODE_STATISTICS_H
+#define NODE_STATISTICS_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "bt_editor_base.h"
+
+// Log-scale histogram of durations (1 microsecond to ~3 hours, 10 buckets per decade).
+// Memory is constant, no matter how many samples are added.
+class DurationHistogram
+{
+public:
+    DurationHistogram();
+
+    void add(double seconds);
+
+    // approximated by the geometric center of the bucket
+    double percentile(double p) const;
+
+    uint64_t count() const { return _count; }
+
+    double max() const { return _max; }
+
+private:
+    static const int BUCKETS = 100;
+    std::array<uint32_t, BUCKETS> _buckets;
+    uint64_t _count;
+    double _max;
+};
+
+struct NodeStatisticsEntry
+{
+    NodeStatisticsEntry();
+
+    // number of times the node left the IDLE state
+    uint64_t ticks;
+    uint64_t success_count;
+    uint64_t failure_count;
+
+    double longest_running;
+    // negative when the node is not RUNNING
+    double running_since;
+    DurationHistogram running_durations;
+
+    double failureRate() const;
+};
+
+// Per-node statistics accumulated from a stream of status transitions.
+// Shared by the offline log statistics and the monitor.
+class NodeStatistics
+{
+public:
+    NodeStatistics() : _transitions_count(0) {}
+
+    void reset(size_t nodes_count);
+
+    void addTransition(size_t index, NodeStatus prev_status,
+                       NodeStatus status, double timestamp);
+
+    const std::vector<NodeStatisticsEntry>& nodes() const { return _nodes; }
+
+    uint64_t transitionsCount() const { return _transitions_count; }
+
+private:
+    std::vector<NodeStatisticsEntry> _nodes;
+    uint64_t _transitions_count;
+};
+
+#endif // NODE_STATISTICS_H
@@ -0,0 +1,248 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <zmq.hpp>
+
+#include "utils.h"
+#include "monitor_protocol.h"
+#include "monitor_publisher.h"
+
+// Publishes the content of a .fbl file like a BT::PublisherZMQ would do, to test
+// and benchmark the monitor without a robot. The transitions of the log are replayed
+// at a multiple of the real time or, with --rate, used to generate a synthetic load.
+
+static std::atomic<bool> g_stop(false);
+
+static void SignalHandler(int)
+{
+    g_stop = true;
+}
+
+static void WriteTimestamp(char* transition, std::chrono::system_clock::time_point time)
+{
+    const auto usec_total = std::chrono::duration_cast<std::chrono::microseconds>(
+                                time.time_since_epoch() ).count();
+    const uint32_t sec  = static_cast<uint32_t>( usec_total / 1000000 );
+    const uint32_t usec = static_cast<uint32_t>( usec_total % 1000000 );
+    std::memcpy( &transition[0], &sec, 4 );
+    std::memcpy( &transition[4], &usec, 4 );
+}
+
+static double ReadTimestamp(const char* transition)
+{
+    const uint32_t sec  = flatbuffers::ReadScalar<uint32_t>( &transition[0] );
+    const uint32_t usec = flatbuffers::ReadScalar<uint32_t>( &transition[4] );
+    return sec + usec * 0.000001;
+}
+
+// Sends the transitions of the log; the ones with the same (scaled) time are
+// grouped into a single message. Timestamps are replaced by the current time.
+static void Replay(MonitorPublisher& publisher, std::string transitions, double speed)
+{
+    const size_t count = transitions.size() / MONITOR_TRANSITION_SIZE;
+    if( count == 0 ) return;
+
+    const double first_time = ReadTimestamp( &transitions[0] );
+    const auto start = std::chrono::system_clock::now();
+
+    size_t first = 0;
+    while( first < count && !g_stop )
+    {
+        const double time = ReadTimestamp( &transitions[ first * MONITOR_TRANSITION_SIZE ] );
+        size_t last = first + 1;
+        while( last < count &&
+               ReadTimestamp( &transitions[ last * MONITOR_TRANSITION_SIZE ] ) == time )
+        {
+            last++;
+        }
+
+        if( speed > 0 )
+        {
+            const auto offset = std::chrono::microseconds(
+                                    static_cast<int64_t>( (time - first_time) * 1e6 / speed ) );
+            std::this_thread::sleep_until( start + offset );
+        }
+        const auto now = std::chrono::system_clock::now();
+        for (size_t t = first; t < last; t++)
+        {
+            WriteTimestamp( &transitions[ t * MONITOR_TRANSITION_SIZE ], now );
+        }
+        publisher.publish( &transitions[ first * MONITOR_TRANSITION_SIZE ], last - first );
+        first = last;
+    }
+}
+
+// Publishes <rate> messages per second, each with <per_message> transitions; every node
+// of the tree goes through RUNNING, SUCCESS and IDLE, one after the other.
+static void Synthetic(MonitorPublisher& publisher, double rate, int per_message, double duration)
+{
+    const std::vector<uint16_t> uids = publisher.uids();
+    if( uids.empty() || rate <= 0 ) return;
+
+    const uint8_t cycle[3] = { static_cast<uint8_t>(Serialization::NodeStatus::RUNNING),
+                               static_cast<uint8_t>(Serialization::NodeStatus::SUCCESS),
+                               static_cast<uint8_t>(Serialization::NodeStatus::IDLE) };
+    std::vector<int> step( uids.size(), 2 );
+    std::string transitions( MONITOR_TRANSITION_SIZE * per_message, '\0' );
+
+    const auto period = std::chrono::microseconds( static_cast<int64_t>( 1e6 / rate ) );
+    const auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    size_t node = 0;
+
+    while( !g_stop )
+    {
+        if( duration > 0 && std::chrono::steady_clock::now() - start >= std::chrono::duration<double>(duration) )
+        {
+            break;
+        }
+        const auto now = std::chrono::system_clock::now();
+        for (int t = 0; t < per_message; t++)
+        {
+            char* ptr = &transitions[ t * MONITOR_TRANSITION_SIZE ];
+            const uint8_t prev = cycle[ step[node] ];
+            step[node] = (step[node] + 1) % 3;
+            WriteTimestamp( ptr, now );
+            std::memcpy( &ptr[8], &uids[node], 2 );
+            ptr[10] = static_cast<char>( prev );
+            ptr[11] = static_cast<char>( cycle[ step[node] ] );
+            node = (node + 1) % uids.size();
+        }
+        publisher.publish( transitions.data(), per_message );
+
+        next += period;
+        std::this_thread::sleep_until( next );
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("groot_publisher");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Publishes a .fbl file like a remote BehaviorTree, to test the monitor");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Log file (.fbl) with the tree and the transitions");
+
+    QCommandLineOption publisher_option("publisher_port", "Port of the publisher (default: 1666)", "port", "1666");
+    parser.addOption(publisher_option);
+
+    QCommandLineOption server_option("server_port", "Port of the server (default: 1667)", "port", "1667");
+    parser.addOption(server_option);
+
+    QCommandLineOption speed_option("speed", "Replay speed, multiple of the real time; 0 is as fast as possible (default: 1)", "factor", "1");
+    parser.addOption(speed_option);
+
+    QCommandLineOption loop_option("loop", "Replay the log until interrupted");
+    parser.addOption(loop_option);
+
+    QCommandLineOption rate_option("rate", "Synthetic load: publish <messages> per second, instead of the transitions of the log", "messages");
+    parser.addOption(rate_option);
+
+    QCommandLineOption transitions_option("transitions", "Synthetic load: transitions per message (default: 10)", "count", "10");
+    parser.addOption(transitions_option);
+
+    QCommandLineOption duration_option("duration", "Synthetic load: stop after <seconds>; 0 is forever (default: 0)", "seconds", "0");
+    parser.addOption(duration_option);
+
+    QCommandLineOption wait_option("wait", "Start publishing when a monitor asks the tree");
+    parser.addOption(wait_option);
+
+    QCommandLineOption shm_option("shm", "Also write the messages into shared memory, for monitors on the same host");
+    parser.addOption(shm_option);
+
+    parser.process( app );
+
+    if( parser.positionalArguments().size() != 1 )
+    {
+        parser.showHelp(1);
+    }
+
+    QFile file( parser.positionalArguments().front() );
+    if( !file.open(QIODevice::ReadOnly) )
+    {
+        std::cerr << "Can't open " << file.fileName().toStdString() << std::endl;
+        return 1;
+    }
+    const QByteArray content = file.readAll();
+
+    const uint32_t tree_size = content.size() >= 4 ? flatbuffers::ReadScalar<uint32_t>( content.data() ) : 0;
+    if( tree_size == 0 || 4 + size_t(tree_size) > size_t(content.size()) )
+    {
+        std::cerr << "Not a valid .fbl file" << std::endl;
+        return 1;
+    }
+    const std::string tree_buffer( content.data() + 4, tree_size );
+    flatbuffers::Verifier verifier( reinterpret_cast<const uint8_t*>(tree_buffer.data()), tree_buffer.size() );
+    if( !Serialization::VerifyBehaviorTreeBuffer(verifier) )
+    {
+        std::cerr << "Not a valid .fbl file" << std::endl;
+        return 1;
+    }
+    const size_t transitions_size = (content.size() - 4 - tree_size) / MONITOR_TRANSITION_SIZE * MONITOR_TRANSITION_SIZE;
+    const std::string transitions( content.data() + 4 + tree_size, transitions_size );
+
+    std::signal( SIGINT, SignalHandler );
+    std::signal( SIGTERM, SignalHandler );
+
+    zmq::context_t context(1);
+    try{
+        const std::string address_pub = "tcp://*:" + parser.value(publisher_option).toStdString();
+        const std::string address_rep = "tcp://*:" + parser.value(server_option).toStdString();
+        MonitorPublisher publisher( context, address_pub, address_rep );
+        publisher.setTree( tree_buffer );
+        if( parser.isSet(shm_option) )
+        {
+            const std::string shm_name = MonitorShmName( parser.value(publisher_option).toStdString() );
+            publisher.addSharedMemory( shm_name );
+            std::cout << "Shared memory: " << shm_name << std::endl;
+        }
+
+        if( parser.isSet(wait_option) )
+        {
+            std::cout << "Waiting for a monitor..." << std::endl;
+            while( publisher.requestsCount() == 0 && !g_stop )
+            {
+                std::this_thread::sleep_for( std::chrono::milliseconds(50) );
+            }
+            // the monitor subscribes before asking the tree; give it time to complete
+            std::this_thread::sleep_for( std::chrono::milliseconds(200) );
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        if( parser.isSet(rate_option) )
+        {
+            Synthetic( publisher, parser.value(rate_option).toDouble(),
+                       std::max( 1, parser.value(transitions_option).toInt() ),
+                       parser.value(duration_option).toDouble() );
+        }
+        else{
+            do {
+                Replay( publisher, transitions, parser.value(speed_option).toDouble() );
+            } while( parser.isSet(loop_option) && !g_stop );
+        }
+        const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        std::cout << "Published " << publisher.publishedCount() << " messages in "
+                  << elapsed << " s" << std::endl;
+    }
+    catch( zmq::error_t& err)
+    {
+        std::cerr << "ZMQ error: " << err.what() << std::endl;
+        return 1;
+    }
+    catch( std::runtime_error& err)
+    {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
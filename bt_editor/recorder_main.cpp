@@ -0,0 +1,181 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include <zmq.hpp>
+
+#include "utils.h"
+#include "monitor_protocol.h"
+#include "log_writer.h"
+
+// Records the status stream of a BT::PublisherZMQ into .fbl files, without GUI.
+// Files are rotated when they exceed a given size or duration, or when the
+// server publishes a different tree.
+
+static std::atomic<bool> g_stop(false);
+
+static void SignalHandler(int)
+{
+    g_stop = true;
+}
+
+static QString NewFilename(const QDir& dir, const QString& prefix)
+{
+    const QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+    QString filename = dir.filePath( QString("%1_%2.fbl").arg(prefix, timestamp) );
+    for (int i = 1; QFileInfo::exists(filename); i++)
+    {
+        filename = dir.filePath( QString("%1_%2_%3.fbl").arg(prefix, timestamp).arg(i) );
+    }
+    return filename;
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("groot_recorder");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Records the status of a remote BehaviorTree into .fbl files");
+    parser.addHelpOption();
+
+    QCommandLineOption address_option("address", "Address of the robot (default: localhost)", "address", "localhost");
+    parser.addOption(address_option);
+
+    QCommandLineOption publisher_option("publisher_port", "Port of the publisher (default: 1666)", "port", "1666");
+    parser.addOption(publisher_option);
+
+    QCommandLineOption server_option("server_port", "Port of the server (default: 1667)", "port", "1667");
+    parser.addOption(server_option);
+
+    QCommandLineOption output_option("output", "Directory of the recorded files (default: current)", "dir", ".");
+    parser.addOption(output_option);
+
+    QCommandLineOption prefix_option("prefix", "Prefix of the filenames (default: bt_trace)", "prefix", "bt_trace");
+    parser.addOption(prefix_option);
+
+    QCommandLineOption size_option("max-size", "Rotate the file when it is larger than <MB> (default: 100)", "MB", "100");
+    parser.addOption(size_option);
+
+    QCommandLineOption duration_option("max-duration", "Rotate the file after <seconds> (default: 3600)", "seconds", "3600");
+    parser.addOption(duration_option);
+
+    parser.process( app );
+
+    QDir dir( parser.value(output_option) );
+    if( !dir.exists() && !QDir().mkpath( dir.path() ) )
+    {
+        std::cerr << "Can't create the directory " << dir.path().toStdString() << std::endl;
+        return 1;
+    }
+
+    const std::string address = parser.value(address_option).toStdString();
+    const std::string address_pub = "tcp://" + address + ":" + parser.value(publisher_option).toStdString();
+    const std::string address_req = "tcp://" + address + ":" + parser.value(server_option).toStdString();
+    const uint64_t max_size = parser.value(size_option).toULongLong() * 1024 * 1024;
+    const auto max_duration = std::chrono::seconds( parser.value(duration_option).toLongLong() );
+
+    std::signal( SIGINT, SignalHandler );
+    std::signal( SIGTERM, SignalHandler );
+
+    zmq::context_t context(1);
+    LogWriter writer;
+
+    try{
+        // connect the subscriber before asking the tree, to lose as few messages as possible
+        zmq::socket_t subscriber( context, ZMQ_SUB );
+        int unlimited = 0;
+        int timeout_ms = 100;
+        subscriber.setsockopt(ZMQ_RCVHWM, &unlimited, sizeof(int) );
+        subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
+        subscriber.setsockopt(ZMQ_RCVTIMEO, &timeout_ms, sizeof(int) );
+        subscriber.connect( address_pub.c_str() );
+
+        std::string tree_buffer;
+        std::vector<uint16_t> tree_uids;
+        uint64_t file_size = 0;
+        auto file_start = std::chrono::steady_clock::now();
+
+        auto fetchTree = [&]() -> bool
+        {
+            zmq::message_t reply;
+            while( !g_stop )
+            {
+                if( RequestTreeFromServer( context, address_req, 1000, reply ) )
+                {
+                    tree_buffer.assign( reinterpret_cast<const char*>(reply.data()), reply.size() );
+                    auto fb_behavior_tree = Serialization::GetBehaviorTree( tree_buffer.data() );
+                    tree_uids = TreeNodesUID( fb_behavior_tree );
+                    return true;
+                }
+                std::cerr << "Waiting for the server at " << address_req << std::endl;
+            }
+            return false;
+        };
+
+        auto rotate = [&]()
+        {
+            const QString filename = NewFilename( dir, parser.value(prefix_option) );
+            writer.openFile( filename.toStdString(), tree_buffer );
+            file_size = 4 + tree_buffer.size();
+            file_start = std::chrono::steady_clock::now();
+            std::cout << "Recording into " << filename.toStdString() << std::endl;
+        };
+
+        if( fetchTree() )
+        {
+            rotate();
+        }
+
+        zmq::message_t msg;
+        while( !g_stop )
+        {
+            if( !subscriber.recv(&msg) )
+            {
+                continue;
+            }
+            const char* buffer = reinterpret_cast<const char*>(msg.data());
+            uint32_t header_size = 0;
+            uint32_t num_transitions = 0;
+            if( !ParseStatusMessage( buffer, msg.size(), header_size, num_transitions ) )
+            {
+                std::cerr << "Skipping a malformed message" << std::endl;
+                continue;
+            }
+
+            // the server is publishing another tree, even if it has the same size
+            if( !StatusHeaderMatches( buffer, header_size, tree_uids ) )
+            {
+                if( !fetchTree() ) break;
+                rotate();
+                if( !StatusHeaderMatches( buffer, header_size, tree_uids ) ) continue;
+            }
+
+            // transitions have the same format in the message and in the file
+            const size_t size = MONITOR_TRANSITION_SIZE * num_transitions;
+            writer.append( &buffer[ StatusMessageTransitionsOffset(header_size) ], size );
+            file_size += size;
+
+            if( ( max_size > 0 && file_size >= max_size ) ||
+                ( max_duration.count() > 0 && std::chrono::steady_clock::now() - file_start >= max_duration ) )
+            {
+                rotate();
+            }
+        }
+    }
+    catch( zmq::error_t& err)
+    {
+        std::cerr << "ZMQ error: " << err.what() << std::endl;
+        return 1;
+    }
+
+    writer.flush();
+    std::cout << "Recorded " << writer.bytesWritten() << " bytes" << std::endl;
+    return writer.hasFailed() ? 1 : 0;
+}
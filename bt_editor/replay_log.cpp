@@ -0,0 +1,169 @@
+#include "replay_log.h"
+#include <algorithm>
+#include <cmath>
+#include "utils.h"
+
+ReplayLog ReadReplayLog(const QByteArray &content)
+{
+    const char* buffer = reinterpret_cast<const char*>(content.data());
+
+    // how many bytes did we read off the disk (uoffset_t aka uint32_t)
+    const size_t read_bytes = content.size();
+
+    // we need at least 4 bytes to read the bt_header_size
+    if( read_bytes < 4 ) {
+        throw std::runtime_error("This Log file is empty");
+    }
+
+    // read the length of the header section from the file
+    const size_t bt_header_size = flatbuffers::ReadScalar<uint32_t>(buffer);
+
+    // if the length of the header goes past the end of the file, it is invalid
+    if( (bt_header_size == 0) || (bt_header_size > read_bytes) ) {
+        throw std::runtime_error("This Log file corrupted or truncated");
+    }
+
+    flatbuffers::Verifier verifier( reinterpret_cast<const uint8_t*>(buffer+4),
+                                    read_bytes -4 );
+
+    if( ! Serialization::VerifyBehaviorTreeBuffer(verifier) )
+    {
+        throw std::runtime_error("Its format is not compatible with the current one");
+    }
+
+    auto fb_behavior_tree = Serialization::GetBehaviorTree( &buffer[4] );
+    auto res_pair = BuildTreeFromFlatbuffers( fb_behavior_tree );
+
+    ReplayLog log;
+    log.tree = std::move( res_pair.first );
+    log.uid_to_index = std::move( res_pair.second );
+
+    auto& transitions = log.transitions;
+    transitions.reserve( (read_bytes - 4 - bt_header_size) / 12 );
+
+    int idle_counter = log.tree.nodes().size();
+    const int total_nodes = log.tree.nodes().size();
+    int nearest_restart_transition_index = 0;
+
+    for (size_t offset = 4+bt_header_size; offset +12 <= read_bytes; offset += 12)
+    {
+        LogTransition transition;
+        const double t_sec  = flatbuffers::ReadScalar<uint32_t>( &buffer[offset] );
+        const double t_usec = flatbuffers::ReadScalar<uint32_t>( &buffer[offset+4] );
+        double timestamp = t_sec + t_usec* 0.000001;
+        transition.timestamp = timestamp;
+        const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset+8]);
+        transition.index = log.uid_to_index.at(uid);
+        transition.prev_status = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+10] ));
+        transition.status      = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+11] ));
+        transition.is_tree_restart = false;
+
+        if(transition.index == 1 &&
+                (transition.status == NodeStatus::RUNNING || transition.status == NodeStatus::IDLE) &&
+                idle_counter >= total_nodes - 1){
+            transition.is_tree_restart = true;
+            nearest_restart_transition_index = transitions.size();
+        }
+
+        if(transition.prev_status != NodeStatus::IDLE && transition.status == NodeStatus::IDLE)
+            idle_counter++;
+        else if(transition.prev_status == NodeStatus::IDLE && transition.status != NodeStatus::IDLE)
+            idle_counter--;
+
+        transition.nearest_restart_transition_index = nearest_restart_transition_index;
+
+        transitions.push_back(transition);
+    }
+    return log;
+}
+
+std::vector<LogTick> SegmentTicks(const std::vector<LogTransition>& transitions)
+{
+    std::vector<LogTick> ticks;
+
+    if( transitions.empty() )
+    {
+        return ticks;
+    }
+
+    auto closeTick = [&](size_t first, size_t last)
+    {
+        LogTick tick;
+        tick.first_transition = first;
+        tick.last_transition  = last;
+        tick.start_time = transitions[first].timestamp;
+        tick.duration   = transitions[last].timestamp - transitions[first].timestamp;
+
+        tick.active_nodes.reserve( last - first + 1 );
+        for (size_t t = first; t <= last; t++)
+        {
+            tick.active_nodes.push_back( transitions[t].index );
+        }
+        std::sort( tick.active_nodes.begin(), tick.active_nodes.end() );
+        tick.active_nodes.erase( std::unique( tick.active_nodes.begin(), tick.active_nodes.end() ),
+                                 tick.active_nodes.end() );
+        ticks.push_back( std::move(tick) );
+    };
+
+    // transitions recorded before the first restart are considered part of the first tick
+    size_t first = 0;
+    for (size_t t = 1; t < transitions.size(); t++)
+    {
+        if( transitions[t].is_tree_restart )
+        {
+            closeTick( first, t-1 );
+            first = t;
+        }
+    }
+    closeTick( first, transitions.size() -1 );
+
+    return ticks;
+}
+
+TickStatistics ComputeTickStatistics(const std::vector<LogTick>& ticks, int bins_count)
+{
+    TickStatistics stats;
+
+    if( ticks.empty() || bins_count <= 0 )
+    {
+        return stats;
+    }
+
+    std::vector<double> durations;
+    durations.reserve( ticks.size() );
+    double total = 0;
+    for (const auto& tick: ticks)
+    {
+        durations.push_back( tick.duration );
+        total += tick.duration;
+    }
+    std::sort( durations.begin(), durations.end() );
+
+    // nearest-rank percentile
+    auto percentile = [&durations](double p) -> double
+    {
+        size_t rank = static_cast<size_t>( std::ceil( p * durations.size() ) );
+        rank = std::max<size_t>( rank, 1 );
+        return durations[ std::min( rank, durations.size() ) -1 ];
+    };
+
+    stats.p50  = percentile( 0.50 );
+    stats.p99  = percentile( 0.99 );
+    stats.max  = durations.back();
+    stats.mean = total / durations.size();
+
+    stats.histogram.assign( bins_count, 0 );
+    if( stats.max <= 0 )
+    {
+        stats.histogram.front() = durations.size();
+        return stats;
+    }
+
+    stats.bin_width = stats.max / bins_count;
+    for (double duration: durations)
+    {
+        int bin = static_cast<int>( duration / stats.bin_width );
+        stats.histogram[ std::min( bin, bins_count -1 ) ]++;
+    }
+    return stats;
+}
@@ -0,0 +1,57 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include <vector>
+#include <unordered_map>
+#include <QByteArray>
+#include "bt_editor_base.h"
+
+struct LogTransition
+{
+    int16_t index;
+    double timestamp;
+    NodeStatus prev_status;
+    NodeStatus status;
+    bool is_tree_restart;
+    int nearest_restart_transition_index;
+};
+
+struct ReplayLog
+{
+    AbsBehaviorTree tree;
+    std::unordered_map<int, int> uid_to_index;
+    std::vector<LogTransition> transitions;
+};
+
+// Decode the content of a .fbl file. Throws std::runtime_error if it is not valid.
+ReplayLog ReadReplayLog(const QByteArray& content);
+
+// A tick spans from a tree restart (included) to the next one (excluded).
+struct LogTick
+{
+    size_t first_transition;
+    size_t last_transition;
+    double start_time;
+    double duration;
+    // indexes of the nodes that changed status during this tick, sorted
+    std::vector<int> active_nodes;
+};
+
+struct TickStatistics
+{
+    TickStatistics(): p50(0), p99(0), max(0), mean(0), bin_width(0) {}
+
+    double p50;
+    double p99;
+    double max;
+    double mean;
+
+    double bin_width;
+    std::vector<int> histogram;
+};
+
+std::vector<LogTick> SegmentTicks(const std::vector<LogTransition>& transitions);
+
+TickStatistics ComputeTickStatistics(const std::vector<LogTick>& ticks, int bins_count = 20);
+
+#endif // REPLAY_LOG_H
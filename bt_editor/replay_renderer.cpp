@@ -0,0 +1,250 @@
+#include "replay_renderer.h"
+#include <QDir>
+#include <QImage>
+#include <QPainter>
+#include <QThread>
+#include <QDebug>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <nodes/Node>
+
+#include "utils.h"
+#include "status_overlay.h"
+
+namespace {
+
+// colors and widths of the status outline, precomputed because
+// getStyleFromStatus is not meant to be called from the worker threads
+struct StatusPen
+{
+    bool visible;
+    QColor node_color;
+    qreal node_width;
+    QColor connection_color;
+    qreal connection_width;
+};
+
+struct NodeGeometryInfo
+{
+    QRectF rect;
+    QPainterPath connection;
+};
+
+struct FrameStatus
+{
+    uint8_t status;
+    uint8_t prev_status;
+};
+
+struct FrameSnapshot
+{
+    size_t frame;
+    std::vector<FrameStatus> status;
+};
+
+}
+
+int RenderReplayFrames(QtNodes::FlowScene& scene,
+                       const std::vector<LogTransition>& transitions,
+                       const ReplayRenderOptions& options)
+{
+
+    QDir dir( options.output_dir );
+    if( !dir.exists() && !QDir().mkpath( options.output_dir ) )
+    {
+        qDebug() << "Can't create the directory " << options.output_dir;
+        return -1;
+    }
+    if( transitions.empty() || options.fps <= 0 )
+    {
+        return 0;
+    }
+
+    auto tree = BuildTreeFromScene( &scene );
+    const size_t nodes_count = tree.nodesCount();
+
+    //---------- static geometry -------------
+    std::vector<NodeGeometryInfo> geometry( nodes_count );
+    for (size_t index = 0; index < nodes_count; index++)
+    {
+        StatusOverlayItem::nodeOutline( *tree.node(index)->graphic_node,
+                                        geometry[index].rect, geometry[index].connection );
+    }
+
+    StatusPen pens[4][4];
+    for (int status = 0; status < 4; status++)
+    {
+        for (int prev = 0; prev < 4; prev++)
+        {
+            const auto& style = getStyleFromStatus( static_cast<NodeStatus>(status),
+                                                    static_cast<NodeStatus>(prev) );
+            StatusPen& pen = pens[status][prev];
+            pen.visible = style.outline;
+            pen.node_color = style.node->NormalBoundaryColor;
+            pen.node_width = style.node->PenWidth;
+            pen.connection_color = style.connection->normalColor();
+            pen.connection_width = style.connection->lineWidth();
+        }
+    }
+
+    //---------- background, rasterized once -------------
+    scene.clearSelection();
+    const QRectF source = scene.itemsBoundingRect().adjusted(-20, -20, 20, 20);
+    const qreal scale = std::min( 1.0, options.max_image_size / std::max( source.width(), source.height() ) );
+    const QSize image_size( static_cast<int>( std::ceil( source.width() * scale ) ),
+                            static_cast<int>( std::ceil( source.height() * scale ) ) );
+
+    // the outlines of the monitor and replay modes are drawn by each frame
+    std::vector<QGraphicsItem*> hidden_overlays;
+    for (QGraphicsItem* item: scene.items())
+    {
+        if( item->type() == StatusOverlayItem::Type && item->isVisible() )
+        {
+            item->hide();
+            hidden_overlays.push_back( item );
+        }
+    }
+
+    QImage background( image_size, QImage::Format_ARGB32_Premultiplied );
+    background.fill( QColor(45, 45, 45) );
+    {
+        QPainter painter( &background );
+        painter.setRenderHint( QPainter::Antialiasing );
+        scene.render( &painter, QRectF( QPointF(0,0), image_size ), source );
+    }
+    for (QGraphicsItem* item: hidden_overlays)
+    {
+        item->show();
+    }
+
+    QTransform transform;
+    transform.scale( scale, scale );
+    transform.translate( -source.left(), -source.top() );
+
+    //---------- parallel rasterization -------------
+    const int threads_count = options.threads > 0 ? options.threads :
+                                                    std::max( 1, QThread::idealThreadCount() );
+
+    // the snapshots are produced by this thread while the workers draw them.
+    // The queue is bounded, so the memory used doesn't depend on the length of the log
+    const size_t max_queued = 2 * static_cast<size_t>( threads_count );
+    std::deque<FrameSnapshot> queue;
+    bool producer_done = false;
+    std::mutex mutex;
+    std::condition_variable cv_worker;
+    std::condition_variable cv_producer;
+    std::atomic<int> written(0);
+
+    auto worker = [&]()
+    {
+        while( true )
+        {
+            FrameSnapshot snapshot;
+            {
+                std::unique_lock<std::mutex> lock( mutex );
+                cv_worker.wait( lock, [&]() { return producer_done || !queue.empty(); } );
+                if( queue.empty() )
+                {
+                    return;
+                }
+                snapshot = std::move( queue.front() );
+                queue.pop_front();
+            }
+            cv_producer.notify_one();
+
+            const size_t frame = snapshot.frame;
+            QImage image = background.copy();
+            QPainter painter( &image );
+            painter.setRenderHint( QPainter::Antialiasing );
+            painter.setTransform( transform );
+            painter.setBrush( Qt::NoBrush );
+
+            const auto& status = snapshot.status;
+            for (size_t index = 0; index < nodes_count; index++)
+            {
+                const StatusPen& pen = pens[ status[index].status & 3 ][ status[index].prev_status & 3 ];
+                if( !pen.visible ) continue;
+
+                if( !geometry[index].connection.isEmpty() )
+                {
+                    painter.setPen( QPen( pen.connection_color, pen.connection_width ) );
+                    painter.drawPath( geometry[index].connection );
+                }
+                painter.setPen( QPen( pen.node_color, pen.node_width ) );
+                painter.drawRoundedRect( geometry[index].rect, 3.0, 3.0 );
+            }
+
+            painter.resetTransform();
+            painter.setPen( Qt::white );
+            painter.drawText( QPointF(10, 20), QString("t = %1 s").arg( frame / options.fps, 0, 'f', 3 ) );
+            painter.end();
+
+            const QString filename = dir.filePath( QString("frame_%1.png").arg( frame, 6, 10, QChar('0') ) );
+            if( image.save( filename, "PNG" ) )
+            {
+                written++;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threads_count; i++)
+    {
+        threads.emplace_back( worker );
+    }
+
+    //---------- status snapshot of each frame -------------
+    const double start_time = transitions.front().timestamp;
+    const size_t frames_count = static_cast<size_t>( (transitions.back().timestamp - start_time) * options.fps ) + 1;
+
+    std::vector<FrameStatus> current( nodes_count, {0, 0} );
+    size_t next = 0;
+
+    for (size_t frame = 0; frame < frames_count; frame++)
+    {
+        const bool last_frame = ( frame +1 == frames_count );
+        const double frame_time = start_time + frame / options.fps;
+
+        while( next < transitions.size() &&
+               ( last_frame || transitions[next].timestamp <= frame_time ) )
+        {
+            const auto& trans = transitions[next++];
+            if( trans.is_tree_restart )
+            {
+                std::fill( current.begin(), current.end(), FrameStatus{0, 0} );
+            }
+            if( trans.index >= 0 && static_cast<size_t>(trans.index) < nodes_count )
+            {
+                auto& node_status = current[trans.index];
+                node_status.prev_status = node_status.status;
+                node_status.status = static_cast<uint8_t>( trans.status );
+            }
+        }
+
+        FrameSnapshot snapshot;
+        snapshot.frame = frame;
+        snapshot.status = current;
+        {
+            std::unique_lock<std::mutex> lock( mutex );
+            cv_producer.wait( lock, [&]() { return queue.size() < max_queued; } );
+            queue.push_back( std::move(snapshot) );
+        }
+        cv_worker.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        producer_done = true;
+    }
+    cv_worker.notify_all();
+
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+    return written;
+}
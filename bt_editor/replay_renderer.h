@@ -0,0 +1,30 @@
+#ifndef REPLAY_RENDERER_H
+#define REPLAY_RENDERER_H
+
+#include <QString>
+#include <nodes/FlowScene>
+#include "replay_log.h"
+
+struct ReplayRenderOptions
+{
+    ReplayRenderOptions(): fps(10.0), threads(0), max_image_size(4096) {}
+
+    QString output_dir;
+    double fps;
+    // 0 means QThread::idealThreadCount()
+    int threads;
+    int max_image_size;
+};
+
+// Renders the status of the tree, sampled every 1/fps seconds of the log, into
+// numbered PNG files. The scene is rasterized only once; the status of each frame
+// is drawn on top of a copy of that image by a pool of worker threads, which take
+// the status snapshots from a bounded queue while they are computed.
+//
+// The scene must contain the tree of the log (same indexes as BuildTreeFromScene).
+// Returns the number of frames written, or -1 on error.
+int RenderReplayFrames(QtNodes::FlowScene& scene,
+                       const std::vector<LogTransition>& transitions,
+                       const ReplayRenderOptions& options);
+
+#endif // REPLAY_RENDERER_H
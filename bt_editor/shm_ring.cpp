@@ -0,0 +1,313 @@
+#include "shm_ring.h"
+#include <stdexcept>
+#include <new>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <thread>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+
+namespace {
+
+const uint32_t SHM_MAGIC = 0x47524F54; // "GROT"
+const uint32_t SHM_VERSION = 2;
+// written instead of a length when the message doesn't fit before the end of the ring
+const uint32_t WRAP_MARKER = 0xFFFFFFFF;
+
+inline uint64_t RecordSize(size_t size)
+{
+    // length + payload, aligned to 8 bytes
+    return (4 + size + 7) & ~uint64_t(7);
+}
+
+inline size_t DataOffset()
+{
+    return (sizeof(ShmRingHeader) + 63) & ~size_t(63);
+}
+
+static_assert( sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "the futex must be a plain uint32_t" );
+
+// not FUTEX_PRIVATE: the writer and the readers are different processes
+void FutexWait(std::atomic<uint32_t>* futex, uint32_t expected, int timeout_us)
+{
+#ifdef __linux__
+    struct timespec timeout;
+    timeout.tv_sec  = timeout_us / 1000000;
+    timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+    syscall( SYS_futex, reinterpret_cast<uint32_t*>(futex), FUTEX_WAIT, expected, &timeout, nullptr, 0 );
+#else
+    (void)futex;
+    (void)expected;
+    std::this_thread::sleep_for( std::chrono::microseconds( std::min(timeout_us, 1000) ) );
+#endif
+}
+
+void FutexWakeAll(std::atomic<uint32_t>* futex)
+{
+#ifdef __linux__
+    syscall( SYS_futex, reinterpret_cast<uint32_t*>(futex), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0 );
+#else
+    (void)futex;
+#endif
+}
+
+}
+
+ShmStatusWriter::ShmStatusWriter(const std::string& name, size_t capacity):
+    _name(name),
+    _header(nullptr),
+    _data(nullptr)
+{
+    size_t ring_size = 4096;
+    while( ring_size < capacity ) ring_size *= 2;
+    _mapped_size = DataOffset() + ring_size;
+
+    shm_unlink( _name.c_str() );
+    int fd = shm_open( _name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 );
+    if( fd < 0 )
+    {
+        throw std::runtime_error( "shm_open failed: " + std::string(strerror(errno)) );
+    }
+    if( ftruncate( fd, _mapped_size ) != 0 )
+    {
+        ::close(fd);
+        shm_unlink( _name.c_str() );
+        throw std::runtime_error( "ftruncate failed: " + std::string(strerror(errno)) );
+    }
+    void* ptr = mmap( nullptr, _mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    ::close(fd);
+    if( ptr == MAP_FAILED )
+    {
+        shm_unlink( _name.c_str() );
+        throw std::runtime_error( "mmap failed: " + std::string(strerror(errno)) );
+    }
+
+    _header = new (ptr) ShmRingHeader;
+    _header->capacity = ring_size;
+    _header->version = SHM_VERSION;
+    _header->write_pos.store( 0, std::memory_order_relaxed );
+    _header->waiters.store( 0, std::memory_order_relaxed );
+    _header->wake_seq.store( 0, std::memory_order_relaxed );
+    _data = static_cast<char*>(ptr) + DataOffset();
+    // readers check the magic number last
+    std::atomic_thread_fence( std::memory_order_release );
+    _header->magic = SHM_MAGIC;
+}
+
+ShmStatusWriter::~ShmStatusWriter()
+{
+    munmap( _header, _mapped_size );
+    shm_unlink( _name.c_str() );
+}
+
+bool ShmStatusWriter::write(const char* data, size_t size)
+{
+    const uint64_t capacity = _header->capacity;
+    const uint64_t record_size = RecordSize(size);
+    if( record_size > capacity / 2 )
+    {
+        return false;
+    }
+
+    uint64_t pos = _header->write_pos.load( std::memory_order_relaxed );
+    uint64_t offset = pos & (capacity - 1);
+    if( offset + record_size > capacity )
+    {
+        const uint32_t marker = WRAP_MARKER;
+        std::memcpy( &_data[offset], &marker, 4 );
+        pos += capacity - offset;
+        offset = 0;
+        // the readers that get here must see the marker, not the new data
+        _header->write_pos.store( pos, std::memory_order_release );
+    }
+
+    const uint32_t length = static_cast<uint32_t>(size);
+    std::memcpy( &_data[offset], &length, 4 );
+    std::memcpy( &_data[offset + 4], data, size );
+    _header->write_pos.store( pos + record_size, std::memory_order_release );
+
+    // pairs with the fence in ShmStatusReader::wait(): either the reader sees the
+    // new write_pos, or this sees the reader waiting
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( _header->waiters.load( std::memory_order_relaxed ) > 0 )
+    {
+        _header->wake_seq.fetch_add( 1, std::memory_order_release );
+        FutexWakeAll( &_header->wake_seq );
+    }
+    return true;
+}
+
+ShmStatusReader::ShmStatusReader():
+    _inode(0),
+    _mapped_size(0),
+    _header(nullptr),
+    _data(nullptr),
+    _mask(0),
+    _read_pos(0),
+    _overruns(0)
+{
+}
+
+ShmStatusReader::~ShmStatusReader()
+{
+    close();
+}
+
+bool ShmStatusReader::open(const std::string& name)
+{
+    close();
+    // writable, for the count of the waiters
+    int fd = shm_open( name.c_str(), O_RDWR, 0 );
+    if( fd < 0 )
+    {
+        return false;
+    }
+    struct stat info;
+    if( fstat( fd, &info ) != 0 || size_t(info.st_size) <= DataOffset() )
+    {
+        ::close(fd);
+        return false;
+    }
+    void* ptr = mmap( nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    ::close(fd);
+    if( ptr == MAP_FAILED )
+    {
+        return false;
+    }
+
+    ShmRingHeader* header = static_cast<ShmRingHeader*>(ptr);
+    const uint64_t capacity = header->capacity;
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if( header->magic != SHM_MAGIC || header->version != SHM_VERSION ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        DataOffset() + capacity > size_t(info.st_size) )
+    {
+        munmap( ptr, info.st_size );
+        return false;
+    }
+
+    _name = name;
+    _inode = info.st_ino;
+    _mapped_size = info.st_size;
+    _header = header;
+    _data = static_cast<const char*>(ptr) + DataOffset();
+    _mask = capacity - 1;
+    _read_pos = _header->write_pos.load( std::memory_order_acquire );
+    return true;
+}
+
+void ShmStatusReader::close()
+{
+    if( _header )
+    {
+        munmap( _header, _mapped_size );
+        _header = nullptr;
+        _data = nullptr;
+    }
+}
+
+bool ShmStatusReader::replaced() const
+{
+    if( !_header )
+    {
+        return false;
+    }
+    int fd = shm_open( _name.c_str(), O_RDONLY, 0 );
+    if( fd < 0 )
+    {
+        // removed but not created yet: keep waiting on the old one
+        return false;
+    }
+    struct stat info;
+    const bool same = ( fstat( fd, &info ) != 0 || info.st_ino == _inode );
+    ::close(fd);
+    return !same;
+}
+
+bool ShmStatusReader::read(std::string& buffer)
+{
+    if( !_header )
+    {
+        return false;
+    }
+    const uint64_t capacity = _mask + 1;
+
+    while( true )
+    {
+        const uint64_t write_pos = _header->write_pos.load( std::memory_order_acquire );
+        if( _read_pos == write_pos )
+        {
+            return false;
+        }
+        if( write_pos - _read_pos > capacity )
+        {
+            // overrun: the data we didn't read yet has been overwritten
+            _overruns++;
+            _read_pos = write_pos;
+            return false;
+        }
+
+        const uint64_t offset = _read_pos & _mask;
+        uint32_t length;
+        std::memcpy( &length, &_data[offset], 4 );
+
+        if( length == WRAP_MARKER || offset + RecordSize(length) > capacity )
+        {
+            // a length that doesn't fit is garbage written by the writer meanwhile;
+            // if that is the case, the check below detects the overrun
+            if( length == WRAP_MARKER )
+            {
+                _read_pos += capacity - offset;
+                continue;
+            }
+            _overruns++;
+            _read_pos = write_pos;
+            return false;
+        }
+
+        buffer.assign( &_data[offset + 4], length );
+
+        // Seqlock-like validation: the record might have been overwritten while copying.
+        // The writer copies a record before publishing it, so it might be writing up to
+        // capacity/2 bytes (the largest record) past new_write_pos: that area must not
+        // reach the record we copied, one lap behind.
+        std::atomic_thread_fence( std::memory_order_acquire );
+        const uint64_t new_write_pos = _header->write_pos.load( std::memory_order_relaxed );
+        if( new_write_pos + capacity / 2 - _read_pos > capacity )
+        {
+            _overruns++;
+            _read_pos = new_write_pos;
+            return false;
+        }
+        _read_pos += RecordSize(length);
+        return true;
+    }
+}
+
+bool ShmStatusReader::wait(int timeout_us)
+{
+    if( !_header )
+    {
+        return false;
+    }
+    _header->waiters.fetch_add( 1, std::memory_order_relaxed );
+    const uint32_t seq = _header->wake_seq.load( std::memory_order_acquire );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( _header->write_pos.load( std::memory_order_relaxed ) == _read_pos )
+    {
+        // returns immediately if wake_seq changed since it was read
+        FutexWait( &_header->wake_seq, seq, timeout_us );
+    }
+    _header->waiters.fetch_sub( 1, std::memory_order_relaxed );
+    return _header->write_pos.load( std::memory_order_acquire ) != _read_pos;
+}
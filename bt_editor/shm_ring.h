@@ -0,0 +1,108 @@
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Transport of the monitor for a tree running on the same host: the messages
+// of the publisher (same layout, see monitor_protocol.h) are written into a
+// ring buffer in POSIX shared memory, instead of a TCP socket.
+//
+// There is a single writer and any number of readers; readers modify only the
+// count of the waiters. A reader that is too slow is overrun by the writer: it
+// detects it and skips to the most recent data (a gap, as when ZMQ drops a message).
+//
+// An idle reader can wait on a futex in the segment (Linux only), that the writer
+// wakes after each message while somebody is waiting: the wake-up latency is the one
+// of the scheduler, a few microseconds. Elsewhere, wait() polls every millisecond.
+
+// prefix of the name of the segment, followed by the publisher port
+#define MONITOR_SHM_PREFIX "/groot_monitor_"
+
+// addresses of the monitor in the form shm://<segment name>, e.g. shm:///groot_monitor_1666
+#define MONITOR_SHM_SCHEME "shm://"
+
+inline std::string MonitorShmName(const std::string& publisher_port)
+{
+    return MONITOR_SHM_PREFIX + publisher_port;
+}
+
+struct ShmRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;   // bytes of the data area, a power of two
+    // bytes written since the creation of the segment, never wraps
+    alignas(64) std::atomic<uint64_t> write_pos;
+    // readers blocked in ShmStatusReader::wait(), and the futex they wait on
+    std::atomic<uint32_t> waiters;
+    std::atomic<uint32_t> wake_seq;
+};
+
+class ShmStatusWriter
+{
+public:
+    // Creates (or replaces) the segment. Throws std::runtime_error.
+    ShmStatusWriter(const std::string& name, size_t capacity = 4*1024*1024);
+
+    // the segment is removed
+    ~ShmStatusWriter();
+
+    ShmStatusWriter(const ShmStatusWriter&) = delete;
+    ShmStatusWriter& operator=(const ShmStatusWriter&) = delete;
+
+    // Returns false if the message is larger than half of the ring.
+    bool write(const char* data, size_t size);
+
+private:
+    std::string _name;
+    size_t _mapped_size;
+    ShmRingHeader* _header;
+    char* _data;
+};
+
+class ShmStatusReader
+{
+public:
+    ShmStatusReader();
+    ~ShmStatusReader();
+
+    ShmStatusReader(const ShmStatusReader&) = delete;
+    ShmStatusReader& operator=(const ShmStatusReader&) = delete;
+
+    // Maps the segment, if it exists. Reading starts from the next message.
+    bool open(const std::string& name);
+
+    bool isOpen() const { return _header != nullptr; }
+
+    void close();
+
+    // true if the segment was removed and created again (the publisher was
+    // restarted): this reader is still mapping the old one.
+    bool replaced() const;
+
+    // Copies the next message into buffer. Returns false if there is nothing new.
+    bool read(std::string& buffer);
+
+    // Blocks until a message is written or timeout_us expires.
+    // Returns true if there might be something to read.
+    bool wait(int timeout_us);
+
+    // Times the writer overran this reader, each one followed by a skip to the
+    // newest data. Each overrun loses an unknown number of messages (at least one).
+    uint64_t overrunsCount() const { return _overruns; }
+
+private:
+    std::string _name;
+    uint64_t _inode;
+    size_t _mapped_size;
+    ShmRingHeader* _header;
+    const char* _data;
+    uint64_t _mask;
+    uint64_t _read_pos;
+    uint64_t _overruns;
+};
+
+#endif // SHM_RING_H
@@ -71,7 +71,7 @@ void SidepanelEditor::updateTreeView()
     for (const auto &it : _tree_nodes_model)
     {
       const auto& ID = it.first;
-      const NodeModel& model = it.second;
+      const NodeModel& model = *it.second;
 
       if( model.registration_ID == "Root")
       {
@@ -113,7 +113,7 @@ void SidepanelEditor::on_paletteTreeWidget_itemSelectionChanged()
     ui->paramsFrame->setHidden(false);
     ui->label->setText( item_name + QString(" Parameters"));
 
-    const auto& model = _tree_nodes_model.at(item_name);
+    const auto& model = *_tree_nodes_model.at(item_name);
 
     ui->portsTableWidget->setRowCount( model.ports.size() );
 
@@ -151,9 +151,9 @@ void SidepanelEditor::on_buttonAddNode_clicked()
     if( dialog.exec() == QDialog::Accepted)
     {
         auto new_model = dialog.getTreeNodeModel();
-        if( new_model.type == NodeType::SUBTREE )
+        if( new_model->type == NodeType::SUBTREE )
         {
-            emit addSubtree( new_model.registration_ID );
+            emit addSubtree( new_model->registration_ID );
         }
         emit addNewModel( new_model );
     }
@@ -162,7 +162,7 @@ void SidepanelEditor::on_buttonAddNode_clicked()
 
 void SidepanelEditor::onRemoveModel(QString selected_name)
 {
-    NodeType node_type = _tree_nodes_model.at(selected_name).type;
+    NodeType node_type = _tree_nodes_model.at(selected_name)->type;
 
     _tree_nodes_model.erase( selected_name );
     _model_registry->unregisterModel(selected_name);
@@ -226,18 +226,18 @@ void SidepanelEditor::onContextMenu(const QPoint& pos)
 }
 
 void SidepanelEditor::onReplaceModel(const QString& old_name,
-                                     const NodeModel &new_model)
+                                     const NodeModelPtr &new_model)
 {
     _tree_nodes_model.erase( old_name );
     _model_registry->unregisterModel( old_name );
     emit addNewModel( new_model );
 
-    if( new_model.type == NodeType::SUBTREE )
+    if( new_model->type == NodeType::SUBTREE )
     {
-       emit renameSubtree(old_name, new_model.registration_ID);
+       emit renameSubtree(old_name, new_model->registration_ID);
     }
 
-    emit nodeModelEdited(old_name, new_model.registration_ID);
+    emit nodeModelEdited(old_name, new_model->registration_ID);
 }
 
 
@@ -253,7 +253,7 @@ void SidepanelEditor::on_buttonUpload_clicked()
     for(const auto& tree_it: _tree_nodes_model)
     {
         const auto& ID    = tree_it.first;
-        const auto& model = tree_it.second;
+        const auto& model = *tree_it.second;
 
         if( BuiltinNodeModels().count(ID) != 0 )
         {
@@ -403,7 +403,8 @@ NodeModels SidepanelEditor::importFromXML(QFile* file)
          model_element = model_element.nextSiblingElement() )
     {
         auto model = buildTreeNodeModelFromXML(model_element);
-        custom_models.insert( { model.registration_ID, model } );
+        const QString ID = model.registration_ID;
+        custom_models.insert( { ID, MakeNodeModel( std::move(model) ) } );
     }
 
     return custom_models;
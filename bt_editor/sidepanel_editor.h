@@ -28,7 +28,7 @@ public:
 public slots:
     void onRemoveModel(QString selected_name);
 
-    void onReplaceModel(const QString &old_name, const NodeModel &new_model);
+    void onReplaceModel(const QString &old_name, const NodeModelPtr &new_model);
 
 
 private slots:
@@ -49,7 +49,7 @@ private slots:
 
 signals:
 
-    void addNewModel(const NodeModel &new_model);
+    void addNewModel(const NodeModelPtr &new_model);
 
     void modelRemoveRequested(QString ID);
 
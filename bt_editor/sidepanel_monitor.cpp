@@ -6,19 +6,42 @@
 #include <QTimer>
 #include <QLabel>
 #include <QDebug>
+#include <QFileDialog>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <chrono>
+#include <set>
 
 #include "utils.h"
+#include "monitor_protocol.h"
+#include "shm_ring.h"
+
+namespace {
+const int TREE_REQUEST_TIMEOUT_MS = 1000;
+const int MIN_RETRY_DELAY_MS = 500;
+const int MAX_RETRY_DELAY_MS = 8000;
+// the sandbox uses the context of the monitor
+const char* SANDBOX_ADDRESS_PUB = "inproc://groot_sandbox_pub";
+const char* SANDBOX_ADDRESS_REP = "inproc://groot_sandbox_rep";
+const int SANDBOX_TRANSPORT = 2;
+}
 
 SidepanelMonitor::SidepanelMonitor(QWidget *parent) :
     QFrame(parent),
     ui(new Ui::SidepanelMonitor),
     _zmq_context(1),
-    _zmq_subscriber(_zmq_context, ZMQ_SUB),
+    _receiver(_zmq_context),
     _connected(false),
-    _msg_count(0)
+    _next_connection_id(0),
+    _selected(nullptr),
+    _coalesced_total(0)
 {
     ui->setupUi(this);
     _timer = new QTimer(this);
+    ui->buttonAddConnection->setEnabled(false);
+    ui->buttonRemoveConnection->setEnabled(false);
+    on_comboPolicy_currentIndexChanged( ui->comboPolicy->currentIndex() );
+    on_comboTransport_currentIndexChanged( ui->comboTransport->currentIndex() );
 
     connect( _timer, &QTimer::timeout, this, &SidepanelMonitor::on_timer );
 }
@@ -31,226 +54,725 @@ SidepanelMonitor::~SidepanelMonitor()
 void SidepanelMonitor::clear()
 {
     if( _connected ) this->on_Connect();
+    // the scenes are cleared by the MainWindow
+    _scene_tree.clear();
+}
+
+void SidepanelMonitor::setSandboxTree(const QString& xml_text, const NodeModels& models)
+{
+    _sandbox_xml = xml_text;
+    _sandbox_models = models;
 }
 
 void SidepanelMonitor::on_timer()
 {
     if( !_connected ) return;
 
-    zmq::message_t msg;
-    try{
-        while(  _zmq_subscriber.recv(&msg) )
+    pollTreeRequests();
+
+    // messages are received and decoded by _receiver; here we only consume the batches
+    const double now = std::chrono::duration<double>(
+                           std::chrono::system_clock::now().time_since_epoch() ).count();
+
+    MonitorStatusBatch& batch = _batch;
+    while( _receiver.pop( batch ) )
+    {
+        auto it = _connections.find( batch.connection_id );
+        if( it == _connections.end() )
         {
-            _msg_count++;
-            ui->labelCount->setText( QString("Messages received: %1").arg(_msg_count) );
-
-            const char* buffer = reinterpret_cast<const char*>(msg.data());
-
-            const uint32_t header_size = flatbuffers::ReadScalar<uint32_t>( buffer );
-            const uint32_t num_transitions = flatbuffers::ReadScalar<uint32_t>( &buffer[4+header_size] );
-            
-            std::vector<std::pair<int, NodeStatus>> node_status;
-            // check uid in the index, if failed load tree from server
-            try{
-                for(size_t offset = 4; offset < header_size +4; offset +=3 )
-                {
-                    const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset]);
-                    _uid_to_index.at(uid);
-                }
-                
-                for(size_t t=0; t < num_transitions; t++)
-                {
-                    size_t offset = 8 + header_size + 12*t;
-                    const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset+8]);
-                    _uid_to_index.at(uid);
-                }
-
-                for(size_t offset = 4; offset < header_size +4; offset +=3 )
-                {
-                    const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset]);
-                    const uint16_t index = _uid_to_index.at(uid);
-                    AbstractTreeNode* node = _loaded_tree.node( index );
-                    node->status = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+2] ));
-                }
-
-                //qDebug() << "--------";
-                for(size_t t=0; t < num_transitions; t++)
-                {
-                    size_t offset = 8 + header_size + 12*t;
-
-                    // const double t_sec  = flatbuffers::ReadScalar<uint32_t>( &buffer[offset] );
-                    // const double t_usec = flatbuffers::ReadScalar<uint32_t>( &buffer[offset+4] );
-                    // double timestamp = t_sec + t_usec* 0.000001;
-                    const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset+8]);
-                    const uint16_t index = _uid_to_index.at(uid);
-                    // NodeStatus prev_status = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[index+10] ));
-                    NodeStatus status  = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+11] ));
-
-                    _loaded_tree.node(index)->status = status;
-                    node_status.push_back( {index, status} );
-
-                }
-            }
-            catch( std::out_of_range& err) {
-                qDebug() << "Reload tree from server";
-                if( !getTreeFromServer() ) {
-                    _connected = false;
-                    ui->lineEdit->setDisabled(false);
-                    _timer->stop();
-                    connectionUpdate(false);
-                    return;
-                }
+            continue; // removed in the meantime
+        }
+        Connection& conn = *it->second;
+        conn.msg_count++;
+
+        if( batch.reload_tree )
+        {
+            qDebug() << "Reload tree from server";
+            conn.tree_loaded = false;
+            conn.retry_delay_ms = 0;
+            requestTree( conn );
+            updateConnectionsList();
+            continue;
+        }
+        if( !conn.tree_loaded )
+        {
+            continue; // sent before the reload was requested
+        }
+
+        applyBatch( conn, batch, now );
+    }
+
+    if( _selected )
+    {
+        ui->labelCount->setText( QString("Messages received: %1").arg(_selected->msg_count) );
+    }
+    updateHistorySlider();
+
+    // update the graphic part, once per frame and connection
+    for(auto& it: _connections)
+    {
+        Connection& conn = *it.second;
+        if( conn.live && !conn.coalescer.empty() )
+        {
+            const uint64_t coalesced = conn.coalescer.coalescedCount();
+            conn.coalescer.takeFrame( _frame_status );
+            _coalesced_total += conn.coalescer.coalescedCount() - coalesced;
+
+            if( !ui->checkHeatmap->isChecked() )
+            {
+                // direct connection: this includes MainWindow::onChangeNodesStatus
+                QElapsedTimer style_timer;
+                style_timer.start();
+                emit changeNodeStyle( conn.bt_name, _frame_status );
+                _stats.addStyleTime( style_timer.nsecsElapsed() * 1e-9 );
             }
+        }
+        if( conn.live && conn.tree_loaded && ui->checkHeatmap->isChecked() )
+        {
+            // rates decay even without new transitions: updated every frame
+            showHeatmap( conn, now );
+        }
+    }
+    updateStats();
+}
 
-            // update the graphic part
-            emit changeNodeStyle( "BehaviorTree", node_status );
+void SidepanelMonitor::applyBatch(Connection& conn, const MonitorStatusBatch& batch, double now)
+{
+    bool gap = false;
+    for(const auto& record: batch.transitions)
+    {
+        const auto status = static_cast<NodeStatus>(record.status);
+        auto node = conn.loaded_tree.node( record.index );
+        gap |= ( static_cast<NodeStatus>(record.prev_status) != node->status );
+        node->status = status;
+        conn.history.push( record );
+        conn.heatmap.addTransition( record.index, now );
+        // meaningful only if the clocks of the robot and of this machine are synchronized
+        _stats.addLatency( now - record.timestamp() );
+        if( conn.live )
+        {
+            conn.coalescer.add( record.index, status );
         }
     }
-    catch( zmq::error_t& err)
+
+    // The header is the full state after the transitions. It differs from ours
+    // when messages were lost (high water mark, CONFLATE or SAMPLE): resync
+    MonitorRecord fix;
+    if( !batch.transitions.empty() )
     {
-        qDebug() << "ZMQ receive failed: " << err.what();
+        fix = batch.transitions.back();
+    }
+    else{
+        fix.sec  = static_cast<uint32_t>( now );
+        fix.usec = static_cast<uint32_t>( (now - fix.sec) * 1e6 );
+    }
+    for(const auto& node_state: batch.state)
+    {
+        auto node = conn.loaded_tree.node( node_state.first );
+        if( node->status == node_state.second )
+        {
+            continue;
+        }
+        gap = true;
+        fix.index = static_cast<uint16_t>( node_state.first );
+        fix.prev_status = static_cast<uint8_t>( node->status );
+        fix.status = static_cast<uint8_t>( node_state.second );
+        node->status = node_state.second;
+        conn.history.push( fix );
+        conn.heatmap.addTransition( fix.index, now );
+        if( conn.live )
+        {
+            conn.coalescer.add( fix.index, node_state.second );
+        }
+    }
+    if( gap )
+    {
+        _stats.addResync();
     }
 }
 
-bool SidepanelMonitor::getTreeFromServer()
+void SidepanelMonitor::updateStats()
 {
-    try{
-        zmq::message_t request(0);
-        zmq::message_t reply;
+    MonitorStatsSample sample;
+    if( _stats.update( _receiver.counters(), _receiver.queueDepth(), _coalesced_total, sample ) )
+    {
+        ui->labelStats->setText( MonitorStatsAccumulator::toText(sample) );
+    }
+}
 
-        zmq::socket_t  zmq_client( _zmq_context, ZMQ_REQ );
-        zmq_client.connect( _connection_address_req.c_str() );
+void SidepanelMonitor::on_buttonExportStats_clicked()
+{
+    if( _stats.samples().empty() )
+    {
+        QMessageBox::information(this, tr("Export statistics"),
+                                 tr("No statistics recorded yet"));
+        return;
+    }
+    QString filename = QFileDialog::getSaveFileName(this, tr("Export statistics"),
+                                                    "monitor_stats.csv", tr("CSV files (*.csv)"));
+    if( filename.isEmpty() )
+    {
+        return;
+    }
+    if( !_stats.exportCSV( filename ) )
+    {
+        QMessageBox::warning(this, tr("Export statistics"),
+                             tr("Cannot write the file [%1]").arg(filename));
+    }
+}
+
+void SidepanelMonitor::updateHistorySlider()
+{
+    ui->groupBoxHistory->setEnabled( _selected != nullptr );
+    if( !_selected )
+    {
+        return;
+    }
+    Connection& conn = *_selected;
+    const uint64_t first = conn.history.firstSequence();
+    if( !conn.live )
+    {
+        // the record shown might have been evicted in the meantime
+        conn.history_seq = std::max( conn.history_seq, first );
+    }
+    const int value = conn.live ? conn.history.size() : (conn.history_seq - first);
+
+    ui->sliderHistory->blockSignals(true);
+    ui->sliderHistory->setRange( 0, conn.history.size() );
+    ui->sliderHistory->setValue( value );
+    ui->sliderHistory->blockSignals(false);
 
-        int timeout_ms = 1000;
-        zmq_client.setsockopt(ZMQ_RCVTIMEO,&timeout_ms, sizeof(int) );
+    ui->buttonLive->blockSignals(true);
+    ui->buttonLive->setChecked( conn.live );
+    ui->buttonLive->blockSignals(false);
+}
 
-        zmq_client.send(request);
+void SidepanelMonitor::showHistoryState(Connection& conn, uint64_t seq)
+{
+    conn.history.stateAt( seq, _history_status, _history_prev );
 
-        bool received = zmq_client.recv(&reply);
-        if( ! received )
+    // same format of StatusCoalescer::takeFrame
+    _frame_status.clear();
+    for (size_t index = 0; index < _history_status.size(); index++)
+    {
+        if( _history_status[index] == NodeStatus::IDLE && _history_prev[index] != NodeStatus::IDLE )
         {
-            return false;
+            _frame_status.push_back( { static_cast<int>(index), _history_prev[index] } );
+        }
+        _frame_status.push_back( { static_cast<int>(index), _history_status[index] } );
+    }
+    emit changeNodeStyle( conn.bt_name, _frame_status );
+}
+
+void SidepanelMonitor::showHeatmap(Connection& conn, double now)
+{
+    _frame_heat.clear();
+    for (size_t index = 1; index < conn.heatmap.size(); index++)
+    {
+        const int step = TransitionHeatmap::levelStep( conn.heatmap.rate( index, now ) );
+        if( step != conn.heat_shown[index] )
+        {
+            conn.heat_shown[index] = step;
+            _frame_heat.push_back( { static_cast<int>(index),
+                                     double(step) / TransitionHeatmap::LEVEL_STEPS } );
+        }
+    }
+    if( !_frame_heat.empty() )
+    {
+        QElapsedTimer style_timer;
+        style_timer.start();
+        emit changeNodeHeat( conn.bt_name, _frame_heat );
+        _stats.addStyleTime( style_timer.nsecsElapsed() * 1e-9 );
+    }
+}
+
+void SidepanelMonitor::on_checkHeatmap_toggled(bool checked)
+{
+    for(auto& it: _connections)
+    {
+        Connection& conn = *it.second;
+        // every node is painted again by the next frame
+        conn.heat_shown.assign( conn.heatmap.size(), -1 );
+        if( !checked && conn.live && conn.tree_loaded )
+        {
+            conn.coalescer.reset( conn.loaded_tree.nodesCount() );
+            showHistoryState( conn, conn.history.endSequence() );
+        }
+    }
+}
+
+void SidepanelMonitor::on_sliderHistory_valueChanged(int value)
+{
+    if( !_selected || _selected->history.empty() ) return;
+    Connection& conn = *_selected;
+
+    conn.live = false;
+    ui->buttonLive->blockSignals(true);
+    ui->buttonLive->setChecked(false);
+    ui->buttonLive->blockSignals(false);
+
+    conn.history_seq = conn.history.firstSequence() + value;
+    showHistoryState( conn, conn.history_seq );
+
+    const double latest = conn.history.at( conn.history.endSequence() -1 ).timestamp();
+    const double shown  = ( conn.history_seq > conn.history.firstSequence() ) ?
+                              conn.history.at( conn.history_seq -1 ).timestamp() :
+                              conn.history.at( conn.history_seq ).timestamp();
+    ui->labelHistory->setText( QString("Paused: %1 s").arg( shown - latest, 0, 'f', 3 ) );
+}
+
+void SidepanelMonitor::on_buttonLive_toggled(bool checked)
+{
+    if( !_selected ) return;
+    Connection& conn = *_selected;
+
+    if( !checked )
+    {
+        // paused, but there is nothing to scrub yet
+        conn.live = false;
+        conn.history_seq = conn.history.endSequence();
+        ui->labelHistory->setText( "Paused" );
+        return;
+    }
+    conn.live = true;
+    ui->labelHistory->setText( "Live" );
+
+    // transitions received while paused are not in the coalescer; show the whole state
+    conn.coalescer.reset( conn.loaded_tree.nodesCount() );
+    showHistoryState( conn, conn.history.endSequence() );
+    conn.heat_shown.assign( conn.heatmap.size(), -1 );
+    updateHistorySlider();
+}
+
+void SidepanelMonitor::on_listConnections_currentRowChanged(int row)
+{
+    _selected = nullptr;
+    if( row >= 0 )
+    {
+        const int id = ui->listConnections->item(row)->data(Qt::UserRole).toInt();
+        auto it = _connections.find( id );
+        if( it != _connections.end() )
+        {
+            _selected = it->second.get();
+        }
+    }
+    ui->buttonRemoveConnection->setEnabled( _selected != nullptr );
+    if( _selected )
+    {
+        ui->labelHistory->setText( _selected->live ? "Live" : "Paused" );
+    }
+    updateHistorySlider();
+}
+
+void SidepanelMonitor::updateConnectionsList()
+{
+    const int selected_id = _selected ? _selected->id : -1;
+
+    ui->listConnections->blockSignals(true);
+    ui->listConnections->clear();
+    int selected_row = -1;
+    for(const auto& it: _connections)
+    {
+        const Connection& conn = *it.second;
+        QString text = QString("%1 [%2]").arg(conn.bt_name, conn.address_pub.c_str());
+        if( !conn.tree_loaded )
+        {
+            text += tr(" (connecting)");
+        }
+        auto item = new QListWidgetItem( text );
+        item->setData( Qt::UserRole, conn.id );
+        ui->listConnections->addItem( item );
+        if( conn.id == selected_id )
+        {
+            selected_row = ui->listConnections->count() -1;
+        }
+    }
+    if( selected_row < 0 && ui->listConnections->count() > 0 )
+    {
+        selected_row = 0;
+    }
+    ui->listConnections->setCurrentRow( selected_row );
+    ui->listConnections->blockSignals(false);
+
+    on_listConnections_currentRowChanged( selected_row );
+}
+
+void SidepanelMonitor::requestTree(Connection& conn)
+{
+    // the REQ socket is created by the task: a request that timed out never
+    // leaves a socket in a broken state
+    zmq::context_t* context = &_zmq_context;
+    const std::string address_req = conn.address_req;
+    conn.tree_request = std::async( std::launch::async, [context, address_req]() -> std::string
+    {
+        try{
+            zmq::message_t reply;
+            if( RequestTreeFromServer( *context, address_req, TREE_REQUEST_TIMEOUT_MS, reply ) )
+            {
+                return std::string( reinterpret_cast<const char*>(reply.data()), reply.size() );
+            }
+        }
+        catch( zmq::error_t& err)
+        {
+            qDebug() << "ZMQ client receive failed: " << err.what();
+        }
+        return std::string();
+    });
+}
+
+void SidepanelMonitor::pollTreeRequests()
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<int> failed_connections;
+    bool changed = false;
+
+    for(auto& it: _connections)
+    {
+        Connection& conn = *it.second;
+        if( conn.tree_loaded )
+        {
+            continue;
+        }
+        if( !conn.tree_request.valid() )
+        {
+            if( now >= conn.next_request )
+            {
+                requestTree( conn );
+            }
+            continue;
+        }
+        if( conn.tree_request.wait_for( std::chrono::seconds(0) ) != std::future_status::ready )
+        {
+            continue;
+        }
+
+        const std::string tree_buffer = conn.tree_request.get();
+        changed = true;
+        if( tree_buffer.empty() )
+        {
+            // try again later, doubling the delay
+            conn.retry_delay_ms = std::min( MAX_RETRY_DELAY_MS,
+                                            std::max( MIN_RETRY_DELAY_MS, conn.retry_delay_ms * 2 ) );
+            conn.next_request = now + std::chrono::milliseconds( conn.retry_delay_ms );
+            qDebug() << "No reply from" << conn.address_req.c_str()
+                     << ", retrying in" << conn.retry_delay_ms << "ms";
+        }
+        else if( installTree( conn, tree_buffer ) )
+        {
+            conn.tree_loaded = true;
+            conn.retry_delay_ms = 0;
         }
+        else{
+            failed_connections.push_back( conn.id );
+        }
+    }
+
+    for(int id: failed_connections)
+    {
+        removeConnection( id );
+    }
+    if( changed && failed_connections.empty() )
+    {
+        updateConnectionsList();
+    }
 
-        const char* buffer = reinterpret_cast<const char*>(reply.data());
-        auto fb_behavior_tree = Serialization::GetBehaviorTree( buffer );
+    // the destructor of a future returned by std::async waits for the task
+    _abandoned_requests.erase(
+                std::remove_if( _abandoned_requests.begin(), _abandoned_requests.end(),
+                                [](const std::future<std::string>& request)
+    {
+        return request.wait_for( std::chrono::seconds(0) ) == std::future_status::ready;
+    }), _abandoned_requests.end() );
+}
 
-        auto res_pair = BuildTreeFromFlatbuffers( fb_behavior_tree );
+bool SidepanelMonitor::installTree(Connection& conn, const std::string& tree_buffer)
+{
+    const char* buffer = tree_buffer.data();
+    auto fb_behavior_tree = Serialization::GetBehaviorTree( buffer );
 
-        _loaded_tree  = std::move( res_pair.first );
-        _uid_to_index = std::move( res_pair.second );
+    // skip BuildTreeFromFlatbuffers and loadBehaviorTree if the tree was already received
+    const MonitorTreeCache::Entry& cached = _tree_cache.get( tree_buffer );
+    const uint64_t tree_id = cached.id;
 
+    conn.loaded_tree  = cached.tree;
+    conn.uid_to_index = cached.uid_to_index;
+
+    // the cached tree has the status of the first reply: use the current one
+    for(size_t index = 0; index < fb_behavior_tree->nodes()->size(); index++ )
+    {
+        const auto fb_status = fb_behavior_tree->nodes()->Get(index)->status();
+        conn.loaded_tree.node( index + 1 )->status = convert( fb_status );
+    }
+
+    _receiver.setTree( conn.id, conn.uid_to_index );
+    conn.coalescer.reset( conn.loaded_tree.nodesCount() );
+    conn.heatmap.reset( conn.loaded_tree.nodesCount() );
+    conn.heat_shown.assign( conn.loaded_tree.nodesCount(), -1 );
+
+    _history_status.clear();
+    for(const auto& tree_node: conn.loaded_tree.nodes())
+    {
+        _history_status.push_back( tree_node.status );
+    }
+    conn.history.reset( _history_status );
+
+    // the history of the previous tree is gone: back to live
+    conn.live = true;
+    if( &conn == _selected )
+    {
+        ui->labelHistory->setText( "Live" );
+    }
+
+    auto scene_tree = _scene_tree.find( conn.bt_name );
+    if( scene_tree == _scene_tree.end() || scene_tree->second != tree_id )
+    {
         // add new models to registry
-        for(const auto& tree_node: _loaded_tree.nodes())
+        std::set<QString> added_models;
+        for(const auto& tree_node: conn.loaded_tree.nodes())
         {
-            const auto& registration_ID = tree_node.model.registration_ID;
-            if( BuiltinNodeModels().count(registration_ID) == 0)
+            const auto& registration_ID = tree_node.model->registration_ID;
+            if( BuiltinNodeModels().count(registration_ID) == 0 &&
+                added_models.insert(registration_ID).second )
             {
                 addNewModel( tree_node.model );
             }
         }
 
         try {
-            loadBehaviorTree( _loaded_tree, "BehaviorTree" );
+            loadBehaviorTree( conn.loaded_tree, conn.bt_name );
+            _scene_tree[ conn.bt_name ] = tree_id;
         }
         catch (std::exception& err) {
+            _scene_tree.erase( conn.bt_name );
             QMessageBox messageBox;
             messageBox.critical(this,"Error Connecting to remote server", err.what() );
             messageBox.show();
             return false;
         }
+    }
 
-        std::vector<std::pair<int, NodeStatus>> node_status;
-        node_status.reserve(_loaded_tree.nodesCount());
+    std::vector<std::pair<int, NodeStatus>> node_status;
+    node_status.reserve(conn.loaded_tree.nodesCount());
 
-        //  qDebug() << "--------";
+    for(size_t t=0; t < conn.loaded_tree.nodesCount(); t++)
+    {
+        node_status.push_back( { t, conn.loaded_tree.nodes()[t].status } );
+    }
+    emit changeNodeStyle( conn.bt_name, node_status );
+    return true;
+}
 
-        for(size_t t=0; t < _loaded_tree.nodesCount(); t++)
+bool SidepanelMonitor::addConnection()
+{
+    QString address = ui->lineEdit->text();
+    if( address.isEmpty() )
+    {
+        address = ui->lineEdit->placeholderText();
+        ui->lineEdit->setText(address);
+    }
+
+    QString publisher_port = ui->lineEdit_publisher->text();
+    if( publisher_port.isEmpty() )
+    {
+        publisher_port = ui->lineEdit_publisher->placeholderText();
+        ui->lineEdit_publisher->setText(publisher_port);
+    }
+
+    QString server_port = ui->lineEdit_server->text();
+    if( server_port.isEmpty() )
+    {
+        server_port = ui->lineEdit_server->placeholderText();
+        ui->lineEdit_server->setText(server_port);
+    }
+
+    std::unique_ptr<Connection> conn( new Connection );
+    conn->id = _next_connection_id++;
+    if( ui->comboTransport->currentIndex() == SANDBOX_TRANSPORT )
+    {
+        conn->address_pub = SANDBOX_ADDRESS_PUB;
+        conn->address_req = SANDBOX_ADDRESS_REP;
+    }
+    else if( ui->comboTransport->currentIndex() == 1 )
+    {
+        // same host: the segment is named after the publisher port
+        conn->address_pub = MONITOR_SHM_SCHEME + MonitorShmName( publisher_port.toStdString() );
+    }
+    else{
+        conn->address_pub = "tcp://" + address.toStdString() + ":" + publisher_port.toStdString();
+    }
+    if( conn->address_req.empty() )
+    {
+        conn->address_req = "tcp://" + address.toStdString() + ":" + server_port.toStdString();
+    }
+
+    // the first robot uses the default tab, the others get a tab with their address
+    bool default_tab_used = false;
+    for(const auto& it: _connections)
+    {
+        if( it.second->address_pub == conn->address_pub )
         {
-            node_status.push_back( { t, _loaded_tree.nodes()[t].status } );
+            QMessageBox::warning(this, tr("ZeroMQ connection"),
+                                 tr("Already connected to [%1]\n").arg(conn->address_pub.c_str()),
+                                 QMessageBox::Close);
+            return false;
         }
-        emit changeNodeStyle( "BehaviorTree", node_status );
+        default_tab_used |= ( it.second->bt_name == "BehaviorTree" );
     }
-    catch( zmq::error_t& err)
+    if( default_tab_used )
+    {
+        conn->bt_name = ( conn->address_pub == SANDBOX_ADDRESS_PUB ) ? QString("Sandbox") :
+                                                                      QString("%1:%2").arg(address, publisher_port);
+    }
+    else{
+        conn->bt_name = "BehaviorTree";
+    }
+
+    if( conn->address_pub == SANDBOX_ADDRESS_PUB && !startSandbox() )
     {
-        qDebug() << "ZMQ client receive failed: " << err.what();
         return false;
     }
+
+    MonitorPolicy policy( static_cast<MonitorPolicy::Mode>( ui->comboPolicy->currentIndex() ),
+                          ui->spinSampleRate->value() );
+
+    // subscribe first; the tree is requested in background and installed by pollTreeRequests
+    _receiver.addConnection( conn->id, conn->address_pub, policy );
+    requestTree( *conn );
+
+    _selected = conn.get();
+    _connections.insert( std::make_pair( conn->id, std::move(conn) ) );
+    updateConnectionsList();
+
+    if( !_connected )
+    {
+        _connected = true;
+        _stats.reset();
+        _coalesced_total = 0;
+        ui->buttonAddConnection->setEnabled(true);
+        _timer->start(20);
+        connectionUpdate(true);
+    }
     return true;
 }
 
-void SidepanelMonitor::on_Connect()
+void SidepanelMonitor::removeConnection(int connection_id)
 {
-    if( !_connected)
+    auto it = _connections.find( connection_id );
+    if( it == _connections.end() )
     {
-        QString address = ui->lineEdit->text();
-        if( address.isEmpty() )
-        {
-            address = ui->lineEdit->placeholderText();
-            ui->lineEdit->setText(address);
-        }
+        return;
+    }
+    _receiver.removeConnection( connection_id );
+    if( it->second->address_pub == SANDBOX_ADDRESS_PUB )
+    {
+        _sandbox.reset();
+    }
+    if( it->second->tree_request.valid() )
+    {
+        _abandoned_requests.push_back( std::move(it->second->tree_request) );
+    }
+    if( _selected == it->second.get() )
+    {
+        _selected = nullptr;
+    }
+    // a new connection with the same name must load its tree again
+    const QString bt_name = it->second->bt_name;
+    _scene_tree.erase( bt_name );
+    _connections.erase( it );
+    updateConnectionsList();
+    emit closeBehaviorTree( bt_name );
+
+    if( _connections.empty() && _connected )
+    {
+        _connected = false;
+        _receiver.stop();
+        ui->buttonAddConnection->setEnabled(false);
+        _timer->stop();
+        connectionUpdate(false);
+    }
+}
 
-        QString publisher_port = ui->lineEdit_publisher->text();
-        if( publisher_port.isEmpty() )
-        {
-            publisher_port = ui->lineEdit_publisher->placeholderText();
-            ui->lineEdit_publisher->setText(publisher_port);
-        }
+void SidepanelMonitor::on_comboPolicy_currentIndexChanged(int index)
+{
+    ui->spinSampleRate->setEnabled( index == MonitorPolicy::SAMPLE );
+}
 
-        QString server_port = ui->lineEdit_server->text();
-        if( server_port.isEmpty() )
-        {
-          publisher_port = ui->lineEdit_server->placeholderText();
-          ui->lineEdit_server->setText(publisher_port);
-        }
+void SidepanelMonitor::on_comboTransport_currentIndexChanged(int index)
+{
+    const bool sandbox = ( index == SANDBOX_TRANSPORT );
+    ui->lineEdit->setEnabled( !sandbox );
+    ui->lineEdit_publisher->setEnabled( !sandbox );
+    ui->lineEdit_server->setEnabled( !sandbox );
+    ui->spinSandboxRate->setEnabled( sandbox );
+}
 
-        bool failed = false;
-        if( !address.isEmpty() )
-        {
-            _connection_address_pub = "tcp://" + address.toStdString() + ":" + publisher_port.toStdString();
-            _connection_address_req = "tcp://" + address.toStdString() + ":" + server_port.toStdString();
+bool SidepanelMonitor::startSandbox()
+{
+    if( _sandbox_xml.isEmpty() )
+    {
+        QMessageBox::warning(this, tr("Sandbox"),
+                             tr("There is no tree to run.\n"
+                                "Create or load one in Editor mode, then switch to Monitor mode."),
+                             QMessageBox::Close);
+        return false;
+    }
 
-            try{
-                _zmq_subscriber.connect( _connection_address_pub.c_str() );
+    SandboxOptions options;
+    options.tick_rate = ui->spinSandboxRate->value();
+    try{
+        _sandbox.reset( new TreeSandbox( _zmq_context, SANDBOX_ADDRESS_PUB, SANDBOX_ADDRESS_REP ) );
+        _sandbox->start( _sandbox_xml, _sandbox_models, options );
+    }
+    catch( zmq::error_t& err )
+    {
+        _sandbox.reset();
+        QMessageBox::warning(this, tr("Sandbox"), tr("ZMQ error: %1").arg(err.what()), QMessageBox::Close);
+        return false;
+    }
+    catch( std::runtime_error& err )
+    {
+        _sandbox.reset();
+        QMessageBox::warning(this, tr("Sandbox"), err.what(), QMessageBox::Close);
+        return false;
+    }
+    return true;
+}
 
-                int timeout_ms = 1;
-                _zmq_subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
-                _zmq_subscriber.setsockopt(ZMQ_RCVTIMEO,&timeout_ms, sizeof(int) );
+void SidepanelMonitor::on_buttonAddConnection_clicked()
+{
+    addConnection();
+}
 
-                if( !getTreeFromServer() )
-                {
-                    failed = true;
-                    _connected = false;
-                }
-            }
-            catch(zmq::error_t& err)
+void SidepanelMonitor::on_buttonRemoveConnection_clicked()
+{
+    if( _selected )
+    {
+        removeConnection( _selected->id );
+    }
+}
+
+void SidepanelMonitor::on_Connect()
+{
+    if( !_connected)
+    {
+        addConnection();
+    }
+    else{
+        _receiver.stop();
+        _sandbox.reset();
+        for(auto& it: _connections)
+        {
+            if( it.second->tree_request.valid() )
             {
-                failed = true;
+                _abandoned_requests.push_back( std::move(it.second->tree_request) );
             }
         }
-        else {
-            failed = true;
-        }
+        _connections.clear();
+        _selected = nullptr;
+        updateConnectionsList();
 
-        if( !failed )
-        {
-            _connected = true;
-            ui->lineEdit->setDisabled(true);
-            ui->lineEdit_publisher->setDisabled(true);
-            _timer->start(20);
-            connectionUpdate(true);
-        }
-        else{
-            QMessageBox::warning(this,
-                                 tr("ZeroMQ connection"),
-                                 tr("Was not able to connect to [%1]\n").arg(_connection_address_pub.c_str()),
-                                 QMessageBox::Close);
-        }
-    }
-    else{
         _connected = false;
-        ui->lineEdit->setDisabled(false);
-        ui->lineEdit_publisher->setDisabled(false);
+        ui->buttonAddConnection->setEnabled(false);
         _timer->stop();
 
         connectionUpdate(false);
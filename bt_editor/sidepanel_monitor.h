@@ -2,9 +2,20 @@
 #define SIDEPANEL_MONITOR_H
 
 #include <QFrame>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
 #include <zmq.hpp>
 
 #include "bt_editor_base.h"
+#include "monitor_receiver.h"
+#include "status_coalescer.h"
+#include "monitor_history.h"
+#include "monitor_tree_cache.h"
+#include "monitor_stats.h"
+#include "transition_heatmap.h"
+#include "tree_sandbox.h"
 
 namespace Ui {
 class SidepanelMonitor;
@@ -20,6 +31,12 @@ public:
 
     void clear();
 
+    // tree run by the sandbox transport: the one of the editor before
+    // switching to monitor mode
+    void setSandboxTree(const QString& xml_text, const NodeModels& models);
+
+    const TreeSandbox* sandbox() const { return _sandbox.get(); }
+
 public slots:
 
     void on_Connect();
@@ -28,6 +45,24 @@ private slots:
 
     void on_timer();
 
+    void on_buttonAddConnection_clicked();
+
+    void on_buttonRemoveConnection_clicked();
+
+    void on_listConnections_currentRowChanged(int row);
+
+    void on_sliderHistory_valueChanged(int value);
+
+    void on_buttonLive_toggled(bool checked);
+
+    void on_buttonExportStats_clicked();
+
+    void on_comboPolicy_currentIndexChanged(int index);
+
+    void on_checkHeatmap_toggled(bool checked);
+
+    void on_comboTransport_currentIndexChanged(int index);
+
 signals:
     void loadBehaviorTree(const AbsBehaviorTree& tree, const QString &bt_name );
 
@@ -36,23 +71,108 @@ signals:
     void changeNodeStyle(const QString& bt_name,
                          const std::vector<std::pair<int, NodeStatus>>& node_status);
 
-    void addNewModel(const NodeModel &new_model);
+    // heatmap mode: level in [0,1] of the nodes that changed
+    void changeNodeHeat(const QString& bt_name,
+                        const std::vector<std::pair<int, double>>& node_heat);
+
+    void addNewModel(const NodeModelPtr &new_model);
+
+    // the connection shown in the tab bt_name was removed
+    void closeBehaviorTree(const QString& bt_name);
 
 private:
     Ui::SidepanelMonitor *ui;
 
+    // one robot being monitored, displayed in the tab bt_name
+    struct Connection
+    {
+        Connection(): history(MONITOR_HISTORY_CAPACITY, MONITOR_HISTORY_MAX_AGE), live(true), history_seq(0), msg_count(0),
+            tree_loaded(false), retry_delay_ms(0) {}
+
+        int id;
+        QString bt_name;
+        std::string address_pub;
+        std::string address_req;
+        AbsBehaviorTree loaded_tree;
+        std::unordered_map<int, int> uid_to_index;
+        StatusCoalescer coalescer;
+
+        MonitorHistory history;
+        bool live;
+        // while paused, the scene shows the state before this record
+        uint64_t history_seq;
+
+        uint64_t msg_count;
+
+        TransitionHeatmap heatmap;
+        // step of the color ramp shown for each node, -1 if unknown
+        std::vector<int> heat_shown;
+
+        // the tree is fetched in background; the request is valid while in progress
+        bool tree_loaded;
+        std::future<std::string> tree_request;
+        std::chrono::steady_clock::time_point next_request;
+        int retry_delay_ms;
+    };
+
     zmq::context_t _zmq_context;
-    zmq::socket_t  _zmq_subscriber;
+    MonitorReceiver _receiver;
 
     bool _connected;
-    std::string _connection_address_pub;
-    std::string _connection_address_req;
     QTimer* _timer;
-    int _msg_count;
-    AbsBehaviorTree _loaded_tree;
-    std::unordered_map<int, int> _uid_to_index;
+    int _next_connection_id;
+    std::map<int, std::unique_ptr<Connection>> _connections;
+    // the connection shown in the history panel
+    Connection* _selected;
+
+    MonitorTreeCache _tree_cache;
+    // MonitorTreeCache::Entry::id of the tree currently loaded in each tab
+    std::map<QString, uint64_t> _scene_tree;
+
+    MonitorStatsAccumulator _stats;
+    uint64_t _coalesced_total;
+
+    // reused, its buffers circulate between this and the receiver thread
+    MonitorStatusBatch _batch;
+    // requests of removed connections, still running
+    std::vector<std::future<std::string>> _abandoned_requests;
+
+    QString _sandbox_xml;
+    NodeModels _sandbox_models;
+    // destroyed before _zmq_context
+    std::unique_ptr<TreeSandbox> _sandbox;
+
+    std::vector<std::pair<int, NodeStatus>> _frame_status;
+    std::vector<NodeStatus> _history_status;
+    std::vector<NodeStatus> _history_prev;
+    std::vector<std::pair<int, double>> _frame_heat;
+
+    bool addConnection();
+
+    void removeConnection(int connection_id);
+
+    void updateConnectionsList();
+
+    void updateHistorySlider();
+
+    void updateStats();
+
+    // applies the transitions and checks the state in the header of the message
+    void applyBatch(Connection& connection, const MonitorStatusBatch& batch, double now);
+
+    void showHistoryState(Connection& connection, uint64_t seq);
+
+    // only the nodes whose color changed are sent to the scene
+    void showHeatmap(Connection& connection, double now);
+
+    void requestTree(Connection& connection);
+
+    // installs the trees received and retries the failed requests
+    void pollTreeRequests();
+
+    bool installTree(Connection& connection, const std::string& tree_buffer);
 
-    bool getTreeFromServer();
+    bool startSandbox();
 
 };
 
@@ -44,6 +44,12 @@ SidepanelReplay::SidepanelReplay(QWidget *parent) :
     connect( _play_timer, &QTimer::timeout, this, &SidepanelReplay::onPlayUpdate );
 
     ui->tableView->installEventFilter(this);
+
+    _ticks_model = new QStandardItemModel(0,4, this);
+    ui->tableViewTicks->setModel(_ticks_model);
+
+    connect( ui->tickHistogram, &TickHistogram::binClicked,
+             this, &SidepanelReplay::onTickHistogramClicked );
 }
 
 SidepanelReplay::~SidepanelReplay()
@@ -55,6 +61,10 @@ void SidepanelReplay::clear()
 {
     _table_model->setColumnCount(4);
     _table_model->setRowCount(0);
+
+    _ticks.clear();
+    _tick_stats = TickStatistics();
+    updateTicksModel();
 }
 
 void SidepanelReplay::updateTableModel(const AbsBehaviorTree& locaded_tree)
@@ -175,54 +185,22 @@ void SidepanelReplay::on_LoadLog()
 
 void SidepanelReplay::loadLog(const QByteArray &content)
 {
-    const char* buffer = reinterpret_cast<const char*>(content.data());
-
-    // how many bytes did we read off the disk (uoffset_t aka uint32_t)
-    const auto read_bytes = content.size();
-
-    // we need at least 4 bytes to read the bt_header_size
-    if( read_bytes < 4 ) {
-        QMessageBox::warning( this, "Log file is empty",
-                             "Failed to load this file.\n"
-                             "This Log file is empty");
-        return;
-    }
-    
-    // read the length of the header section from the file
-    const size_t bt_header_size = flatbuffers::ReadScalar<uint32_t>(buffer);
-
-    // if the length of the header goes past the end of the file, it is invalid
-    if( (bt_header_size == 0) || (bt_header_size > read_bytes) ) {
-        QMessageBox::warning( this, "Log file is corrupt",
-                             "Failed to load this file.\n"
-                             "This Log file corrupted or truncated");
-        return;
+    ReplayLog log;
+    try{
+        log = ReadReplayLog( content );
     }
-
-    flatbuffers::Verifier verifier( reinterpret_cast<const uint8_t*>(buffer+4),
-                                   size_t(content.size() -4));
-
-    bool valid_tree = Serialization::VerifyBehaviorTreeBuffer(verifier);
-    if( ! valid_tree )
+    catch( std::exception& err )
     {
-        QMessageBox::warning( this, "Flatbuffer verification failed",
-                             "Failed to load this file.\n"
-                             "Its format is not compatible with the current one");
+        QMessageBox::warning( this, "Failed to load the Log file",
+                              QString("Failed to load this file.\n%1").arg( err.what() ) );
         return;
     }
 
-
-    auto fb_behavior_tree = Serialization::GetBehaviorTree( &buffer[4] );
-
-
-    auto res_pair = BuildTreeFromFlatbuffers( fb_behavior_tree );
-
-    _loaded_tree  = res_pair.first;
-    const auto& uid_to_index = res_pair.second;
+    _loaded_tree = std::move( log.tree );
 
     for (const auto& tree_node: _loaded_tree.nodes() )
     {
-        const QString& ID = tree_node.model.registration_ID;
+        const QString& ID = tree_node.model->registration_ID;
         if( BuiltinNodeModels().count( ID ) == 0)
         {
             emit addNewModel( tree_node.model );
@@ -231,46 +209,78 @@ void SidepanelReplay::loadLog(const QByteArray &content)
 
     emit loadBehaviorTree( _loaded_tree, "BehaviorTree" );
 
-    _transitions.clear();
-    _transitions.reserve( (content.size() - 4 - bt_header_size) / 12 );
+    _transitions = std::move( log.transitions );
 
-    int idle_counter = _loaded_tree.nodes().size();
-    const int total_nodes = _loaded_tree.nodes().size();
-    int nearest_restart_transition_index = 0;
+    _ticks = SegmentTicks( _transitions );
+    _tick_stats = ComputeTickStatistics( _ticks );
 
-    for (size_t offset = 4+bt_header_size; offset < content.size(); offset += 12)
+    _timepoint.clear();
+    _prev_row = -1;
+    updateTableModel(_loaded_tree);
+    updateTicksModel();
+}
+
+void SidepanelReplay::updateTicksModel()
+{
+    _ticks_model->setRowCount(0);
+    _ticks_model->setHorizontalHeaderLabels( {"Tick", "Time", "Duration [ms]", "Nodes"} );
+
+    const double first_timestamp = _transitions.empty() ? 0.0 : _transitions.front().timestamp;
+
+    for (size_t i = 0; i < _ticks.size(); i++)
     {
-        Transition transition;
-        const double t_sec  = flatbuffers::ReadScalar<uint32_t>( &buffer[offset] );
-        const double t_usec = flatbuffers::ReadScalar<uint32_t>( &buffer[offset+4] );
-        double timestamp = t_sec + t_usec* 0.000001;
-        transition.timestamp = timestamp;
-        const uint16_t uid = flatbuffers::ReadScalar<uint16_t>(&buffer[offset+8]);
-        transition.index = uid_to_index.at(uid);
-        transition.prev_status = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+10] ));
-        transition.status      = convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&buffer[offset+11] ));
-        transition.is_tree_restart = false;
-
-        if(transition.index == 1 &&
-                (transition.status == NodeStatus::RUNNING || transition.status == NodeStatus::IDLE) &&
-                idle_counter >= total_nodes - 1){
-            transition.is_tree_restart = true;
-            nearest_restart_transition_index = _transitions.size();
+        const auto& tick = _ticks[i];
+
+        // store numbers instead of strings, to sort the columns numerically
+        auto index_item = new QStandardItem();
+        index_item->setData( static_cast<int>(i), Qt::DisplayRole );
+
+        auto time_item = new QStandardItem();
+        time_item->setData( tick.start_time - first_timestamp, Qt::DisplayRole );
+
+        auto duration_item = new QStandardItem();
+        duration_item->setData( tick.duration * 1000.0, Qt::DisplayRole );
+        if( tick.duration >= _tick_stats.p99 && _ticks.size() > 1 )
+        {
+            duration_item->setBackground( QColor::fromRgb(255, 150, 150) );
         }
 
-        if(transition.prev_status != NodeStatus::IDLE && transition.status == NodeStatus::IDLE)
-            idle_counter++;
-        else if(transition.prev_status == NodeStatus::IDLE && transition.status != NodeStatus::IDLE)
-            idle_counter--;
+        auto nodes_item = new QStandardItem();
+        nodes_item->setData( static_cast<int>(tick.active_nodes.size()), Qt::DisplayRole );
+
+        _ticks_model->appendRow( {index_item, time_item, duration_item, nodes_item} );
+    }
 
-        transition.nearest_restart_transition_index = nearest_restart_transition_index;
+    // slowest ticks first
+    ui->tableViewTicks->sortByColumn(2, Qt::DescendingOrder);
+    ui->tableViewTicks->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
-        _transitions.push_back(transition);
+    if( _ticks.empty() )
+    {
+        ui->labelTickStats->setText("No ticks");
+    }
+    else{
+        ui->labelTickStats->setText(
+                    QString("Ticks: %1   p50: %2 ms   p99: %3 ms   max: %4 ms")
+                    .arg( _ticks.size() )
+                    .arg( _tick_stats.p50 * 1000.0, 0, 'f', 3 )
+                    .arg( _tick_stats.p99 * 1000.0, 0, 'f', 3 )
+                    .arg( _tick_stats.max * 1000.0, 0, 'f', 3 ) );
     }
+    ui->tickHistogram->setStatistics( _tick_stats );
+}
 
-    _timepoint.clear();
-    _prev_row = -1;
-    updateTableModel(_loaded_tree);
+void SidepanelReplay::jumpToTick(size_t tick_index)
+{
+    if( tick_index >= _ticks.size() || ui->pushButtonPlay->isChecked() )
+    {
+        return;
+    }
+    // show the state of the tree at the end of the tick
+    const int row = _ticks[tick_index].last_transition;
+    onRowChanged( row );
+    updatedSpinAndSlider( row );
+    ui->tableView->scrollTo( _table_model->index(row,0), QAbstractItemView::PositionAtCenter );
 }
 
 
@@ -418,6 +428,37 @@ void SidepanelReplay::on_tableView_clicked(const QModelIndex &index)
     }
 }
 
+void SidepanelReplay::on_tableViewTicks_clicked(const QModelIndex &index)
+{
+    const int tick_index = _ticks_model->item( index.row(), 0 )->data( Qt::DisplayRole ).toInt();
+    jumpToTick( tick_index );
+}
+
+void SidepanelReplay::onTickHistogramClicked(int bin)
+{
+    if( _tick_stats.bin_width <= 0 )
+    {
+        jumpToTick(0);
+        return;
+    }
+    const int bins_count = _tick_stats.histogram.size();
+
+    // the slowest tick that falls into the selected bin
+    int slowest = -1;
+    for (size_t i = 0; i < _ticks.size(); i++)
+    {
+        int tick_bin = std::min( static_cast<int>( _ticks[i].duration / _tick_stats.bin_width ), bins_count -1 );
+        if( tick_bin == bin && ( slowest < 0 || _ticks[i].duration > _ticks[slowest].duration ) )
+        {
+            slowest = i;
+        }
+    }
+    if( slowest >= 0 )
+    {
+        jumpToTick( slowest );
+    }
+}
+
 void SidepanelReplay::onTimerUpdate()
 {
     ui->tableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
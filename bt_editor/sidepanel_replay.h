@@ -6,6 +6,7 @@
 #include <QTableWidgetItem>
 #include <QStandardItemModel>
 #include "bt_editor_base.h"
+#include "replay_log.h"
 
 
 namespace Ui {
@@ -26,6 +27,15 @@ public:
 
     size_t transitionsCount() const { return _transitions.size(); }
 
+    const std::vector<LogTick>& ticks() const { return _ticks; }
+
+    const TickStatistics& tickStatistics() const { return _tick_stats; }
+
+    void jumpToTick(size_t tick_index);
+
+    // row of the transition shown in the scene, -1 if none
+    int currentRow() const { return _prev_row; }
+
 public slots:
 
     void on_LoadLog();
@@ -40,6 +50,10 @@ private slots:
 
     void on_tableView_clicked(const QModelIndex &index);
 
+    void on_tableViewTicks_clicked(const QModelIndex &index);
+
+    void onTickHistogramClicked(int bin);
+
     void onTimerUpdate();
 
     void onPlayUpdate();
@@ -52,7 +66,7 @@ signals:
     void changeNodeStyle(const QString& bt_name,
                          const std::vector<std::pair<int, NodeStatus>>& node_status);
 
-    void addNewModel(const NodeModel &new_model);
+    void addNewModel(const NodeModelPtr &new_model);
 
 private:
 
@@ -64,15 +78,9 @@ private:
 
     Ui::SidepanelReplay *ui;
 
-    struct Transition{
-        int16_t index;
-        double timestamp;
-        NodeStatus prev_status;
-        NodeStatus status;
-        bool is_tree_restart;
-        int nearest_restart_transition_index;
-    };
-    std::vector<Transition> _transitions;
+    std::vector<LogTransition> _transitions;
+    std::vector<LogTick> _ticks;
+    TickStatistics _tick_stats;
     std::vector< std::pair<double,int>> _timepoint;
 
     int _prev_row;
@@ -82,6 +90,8 @@ private:
 
     QStandardItemModel* _table_model;
 
+    QStandardItemModel* _ticks_model;
+
     QTimer *_layout_update_timer;
 
     QTimer *_play_timer;
@@ -89,6 +99,8 @@ private:
     AbsBehaviorTree _loaded_tree;
 
     void updateTableModel(const AbsBehaviorTree &tree);
+
+    void updateTicksModel();
 };
 
 #endif // SIDEPANEL_REPLAY_H
@@ -0,0 +1,103 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// Bounded, lock-free queue for exactly one producer thread and one consumer thread.
+// The capacity is rounded up to a power of two; push() fails when the queue is full.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity):
+        _head(0),
+        _tail(0)
+    {
+        size_t size = 2;
+        while( size < capacity ) size *= 2;
+        _buffer.resize( size );
+        _mask = size -1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // producer side
+    bool push(T&& item)
+    {
+        const size_t tail = _tail.load( std::memory_order_relaxed );
+        if( tail - _head.load( std::memory_order_acquire ) > _mask )
+        {
+            return false;
+        }
+        _buffer[ tail & _mask ] = std::move(item);
+        _tail.store( tail +1, std::memory_order_release );
+        return true;
+    }
+
+    // consumer side
+    bool pop(T& item)
+    {
+        const size_t head = _head.load( std::memory_order_relaxed );
+        if( head == _tail.load( std::memory_order_acquire ) )
+        {
+            return false;
+        }
+        item = std::move( _buffer[ head & _mask ] );
+        _head.store( head +1, std::memory_order_release );
+        return true;
+    }
+
+    // Same as push() and pop(), but the item is swapped with the content of the slot:
+    // the memory owned by the items (vectors, for instance) is recycled by both threads.
+    bool exchangePush(T& item)
+    {
+        const size_t tail = _tail.load( std::memory_order_relaxed );
+        if( tail - _head.load( std::memory_order_acquire ) > _mask )
+        {
+            return false;
+        }
+        std::swap( _buffer[ tail & _mask ], item );
+        _tail.store( tail +1, std::memory_order_release );
+        return true;
+    }
+
+    bool exchangePop(T& item)
+    {
+        const size_t head = _head.load( std::memory_order_relaxed );
+        if( head == _tail.load( std::memory_order_acquire ) )
+        {
+            return false;
+        }
+        std::swap( _buffer[ head & _mask ], item );
+        _head.store( head +1, std::memory_order_release );
+        return true;
+    }
+
+    // approximated when called while the other thread is active
+    size_t size() const
+    {
+        return _tail.load( std::memory_order_acquire ) - _head.load( std::memory_order_acquire );
+    }
+
+    size_t capacity() const { return _mask +1; }
+
+private:
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    std::vector<T> _buffer;
+    size_t _mask;
+    // Head and tail are written by different threads: keep them on separate cache
+    // lines, also from the fields read by both. The queue is allocated with new, that
+    // doesn't honor alignas(64) before C++17: padding works at any alignment.
+    char _pad_head[CACHE_LINE_SIZE];
+    std::atomic<size_t> _head;
+    char _pad_tail[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> _tail;
+    char _pad_end[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,68 @@
+#include "status_coalescer.h"
+
+void StatusCoalescer::reset(size_t nodes_count)
+{
+    _nodes.assign( nodes_count, Entry{ NodeStatus::IDLE, NodeStatus::IDLE, false } );
+    _restarted = false;
+    _pending = 0;
+    _added = 0;
+}
+
+void StatusCoalescer::add(int index, NodeStatus status)
+{
+    if( index < 0 || static_cast<size_t>(index) >= _nodes.size() )
+    {
+        return;
+    }
+
+    // the root started a new tick: onChangeNodesStatus will reset the style of the whole tree
+    if( index == 1 && status == NodeStatus::RUNNING )
+    {
+        _restarted = true;
+        for (auto& node: _nodes)
+        {
+            node.last_non_idle = NodeStatus::IDLE;
+        }
+    }
+
+    _added++;
+    Entry& node = _nodes[index];
+    node.latest = status;
+    if( status != NodeStatus::IDLE )
+    {
+        node.last_non_idle = status;
+    }
+    if( !node.dirty )
+    {
+        node.dirty = true;
+        _pending++;
+    }
+}
+
+void StatusCoalescer::takeFrame(std::vector<std::pair<int, NodeStatus>>& node_status)
+{
+    node_status.clear();
+    _coalesced += _added - _pending;
+    _added = 0;
+
+    // otherwise the RUNNING root is emitted anyway, right after the index 0
+    if( _restarted && _nodes[1].latest != NodeStatus::RUNNING )
+    {
+        node_status.push_back( {1, NodeStatus::RUNNING} );
+    }
+
+    for (size_t index = 0; index < _nodes.size() && _pending > 0; index++)
+    {
+        Entry& node = _nodes[index];
+        if( !node.dirty ) continue;
+
+        if( node.latest == NodeStatus::IDLE && node.last_non_idle != NodeStatus::IDLE )
+        {
+            node_status.push_back( { static_cast<int>(index), node.last_non_idle } );
+        }
+        node_status.push_back( { static_cast<int>(index), node.latest } );
+        node.dirty = false;
+        _pending--;
+    }
+    _restarted = false;
+}
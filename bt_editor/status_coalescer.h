@@ -0,0 +1,44 @@
+#ifndef STATUS_COALESCER_H
+#define STATUS_COALESCER_H
+
+#include <vector>
+#include <cstdint>
+#include "bt_editor_base.h"
+
+// Folds the transitions received between two frames into one entry per node
+// (latest status and last non-idle status), so that the scene is restyled once per frame.
+class StatusCoalescer
+{
+public:
+    StatusCoalescer(): _restarted(false), _pending(0), _added(0), _coalesced(0) {}
+
+    void reset(size_t nodes_count);
+
+    void add(int index, NodeStatus status);
+
+    bool empty() const { return _pending == 0 && !_restarted; }
+
+    // Writes the changes since the previous call, sorted by index, in the format
+    // expected by MainWindow::onChangeNodesStatus. A node that went back to IDLE is
+    // emitted twice (last non-idle status, then IDLE) to keep its result visible.
+    void takeFrame(std::vector<std::pair<int, NodeStatus>>& node_status);
+
+    // transitions folded into another one of the same node, never shown.
+    // Cumulative, not affected by reset()
+    uint64_t coalescedCount() const { return _coalesced; }
+
+private:
+    struct Entry
+    {
+        NodeStatus latest;
+        NodeStatus last_non_idle;
+        bool dirty;
+    };
+    std::vector<Entry> _nodes;
+    bool _restarted;
+    size_t _pending;
+    size_t _added;
+    uint64_t _coalesced;
+};
+
+#endif // STATUS_COALESCER_H
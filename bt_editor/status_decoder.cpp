@@ -0,0 +1,77 @@
+#include "status_decoder.h"
+#include "utils.h"
+#include <algorithm>
+
+namespace {
+const size_t TRANSITION_SIZE = 12;
+}
+
+void StatusMessageDecoder::setTree(const std::unordered_map<int, int>& uid_to_index)
+{
+    int max_uid = -1;
+    for (const auto& it: uid_to_index)
+    {
+        max_uid = std::max( max_uid, it.first );
+    }
+    _uid_to_index.assign( max_uid + 1, -1 );
+    for (const auto& it: uid_to_index)
+    {
+        if( it.first >= 0 )
+        {
+            _uid_to_index[ it.first ] = it.second;
+        }
+    }
+}
+
+StatusMessageDecoder::Result
+StatusMessageDecoder::decode(const char* buffer, size_t size,
+                             std::vector<std::pair<int, NodeStatus>>& state,
+                             std::vector<MonitorRecord>& transitions) const
+{
+    if( size < 8 )
+    {
+        return MALFORMED;
+    }
+    const uint32_t header_size = flatbuffers::ReadScalar<uint32_t>( buffer );
+    if( header_size % 3 != 0 || size_t(header_size) + 8 > size )
+    {
+        return MALFORMED;
+    }
+    const uint32_t num_transitions = flatbuffers::ReadScalar<uint32_t>( &buffer[4+header_size] );
+    const size_t transitions_offset = 8 + header_size;
+    if( (size - transitions_offset) / TRANSITION_SIZE < num_transitions )
+    {
+        return MALFORMED;
+    }
+
+    state.resize( header_size / 3 );
+    for (size_t i = 0; i < state.size(); i++)
+    {
+        const char* ptr = &buffer[ 4 + 3*i ];
+        const int node_index = index( flatbuffers::ReadScalar<uint16_t>(ptr) );
+        if( node_index < 0 )
+        {
+            return UNKNOWN_UID;
+        }
+        state[i].first  = node_index;
+        state[i].second = convert( flatbuffers::ReadScalar<Serialization::NodeStatus>(&ptr[2]) );
+    }
+
+    transitions.resize( num_transitions );
+    for (size_t t = 0; t < num_transitions; t++)
+    {
+        const char* ptr = &buffer[ transitions_offset + TRANSITION_SIZE*t ];
+        const int node_index = index( flatbuffers::ReadScalar<uint16_t>(&ptr[8]) );
+        if( node_index < 0 )
+        {
+            return UNKNOWN_UID;
+        }
+        MonitorRecord& record = transitions[t];
+        record.sec   = flatbuffers::ReadScalar<uint32_t>( ptr );
+        record.usec  = flatbuffers::ReadScalar<uint32_t>( &ptr[4] );
+        record.index = static_cast<uint16_t>( node_index );
+        record.prev_status = static_cast<uint8_t>( convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&ptr[10])) );
+        record.status      = static_cast<uint8_t>( convert(flatbuffers::ReadScalar<Serialization::NodeStatus>(&ptr[11])) );
+    }
+    return OK;
+}
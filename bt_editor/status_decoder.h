@@ -0,0 +1,50 @@
+#ifndef STATUS_DECODER_H
+#define STATUS_DECODER_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "bt_editor_base.h"
+#include "monitor_history.h"
+
+// Decodes the messages of the PUB socket of BT::PublisherZMQ (see monitor_protocol.h)
+// in a single pass, converting the UIDs with a dense array. Nothing is allocated
+// once the output vectors are large enough for the tree.
+class StatusMessageDecoder
+{
+public:
+    enum Result
+    {
+        OK,
+        MALFORMED,    // truncated message
+        UNKNOWN_UID   // the message refers to a different tree
+    };
+
+    StatusMessageDecoder() {}
+
+    // to be called every time a new tree is loaded
+    void setTree(const std::unordered_map<int, int>& uid_to_index);
+
+    void clear() { _uid_to_index.clear(); }
+
+    bool hasTree() const { return !_uid_to_index.empty(); }
+
+    // state and transitions are overwritten, but their capacity is preserved.
+    // On failure, their content is undefined.
+    Result decode(const char* buffer, size_t size,
+                  std::vector<std::pair<int, NodeStatus>>& state,
+                  std::vector<MonitorRecord>& transitions) const;
+
+private:
+    // indexed by UID, -1 if the UID is not in the tree
+    std::vector<int> _uid_to_index;
+
+    int index(uint16_t uid) const
+    {
+        return uid < _uid_to_index.size() ? _uid_to_index[uid] : -1;
+    }
+};
+
+#endif // STATUS_DECODER_H
@@ -0,0 +1,172 @@
+#include "status_overlay.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include "nodes/internal/ConnectionGraphicsObject.hpp"
+
+namespace {
+// larger than the widest pen of the palette
+const qreal PEN_MARGIN = 8.0;
+}
+
+StatusOverlayItem::StatusOverlayItem():
+    _outlines_count(0),
+    _has_visible_rect(false),
+    _pending_count(0)
+{
+    setZValue( 1e6 );
+    setAcceptedMouseButtons( Qt::NoButton );
+    setAcceptHoverEvents( false );
+    setFlag( QGraphicsItem::ItemUsesExtendedStyleOption );
+}
+
+void StatusOverlayItem::nodeOutline(QtNodes::Node& node, QRectF& rect, QPainterPath& connection)
+{
+    using QtNodes::PortType;
+
+    const auto& geom = node.nodeGeometry();
+    rect = QRectF( node.nodeGraphicsObject().pos(), QSizeF( geom.width(), geom.height() ) );
+    connection = QPainterPath();
+
+    if( node.nodeDataModel()->nPorts(PortType::In) == 1 )
+    {
+        const auto& conn_in = node.nodeState().connections(PortType::In, 0 );
+        if( conn_in.size() == 1 )
+        {
+            auto conn = conn_in.begin()->second;
+            const auto& graphic = conn->connectionGraphicsObject();
+            const auto& conn_geom = conn->connectionGeometry();
+            const auto c1c2 = conn_geom.pointsC1C2();
+
+            connection.moveTo( graphic.mapToScene( conn_geom.source() ) );
+            connection.cubicTo( graphic.mapToScene( c1c2.first ),
+                                graphic.mapToScene( c1c2.second ),
+                                graphic.mapToScene( conn_geom.sink() ) );
+        }
+    }
+}
+
+void StatusOverlayItem::setNodes(const std::vector<QtNodes::Node*>& nodes)
+{
+    prepareGeometryChange();
+    if( nodes.size() != _outlines.size() )
+    {
+        _outlines.assign( nodes.size(), Outline() );
+        for (auto& outline: _outlines)
+        {
+            outline.style = nullptr;
+        }
+        _outlines_count = 0;
+    }
+    // everything is repainted below
+    for (auto& outline: _outlines)
+    {
+        outline.pending = false;
+    }
+    _pending_count = 0;
+
+    _bounding_rect = QRectF();
+    for (size_t index = 0; index < nodes.size(); index++)
+    {
+        Outline& outline = _outlines[index];
+        nodeOutline( *nodes[index], outline.rect, outline.connection );
+        outline.dirty_rect = outline.rect.united( outline.connection.boundingRect() )
+                                 .adjusted( -PEN_MARGIN, -PEN_MARGIN, PEN_MARGIN, PEN_MARGIN );
+        _bounding_rect = _bounding_rect.united( outline.dirty_rect );
+    }
+    update();
+}
+
+void StatusOverlayItem::setStyle(size_t index, const SharedNodeStyle* style)
+{
+    Outline& outline = _outlines.at(index);
+    if( style && !style->outline )
+    {
+        style = nullptr;
+    }
+    if( outline.style == style )
+    {
+        return;
+    }
+    if( !outline.style ) _outlines_count++;
+    if( !style )         _outlines_count--;
+
+    outline.style = style;
+    if( !_has_visible_rect || outline.dirty_rect.intersects( _visible_rect ) )
+    {
+        update( outline.dirty_rect );
+    }
+    else if( !outline.pending )
+    {
+        outline.pending = true;
+        _pending_count++;
+    }
+}
+
+void StatusOverlayItem::setVisibleRect(const QRectF& rect)
+{
+    if( _has_visible_rect && rect == _visible_rect )
+    {
+        return;
+    }
+    _visible_rect = rect;
+    _has_visible_rect = true;
+
+    if( _pending_count == 0 || rect.isEmpty() )
+    {
+        return;
+    }
+    for (auto& outline: _outlines)
+    {
+        if( outline.pending && outline.dirty_rect.intersects( rect ) )
+        {
+            outline.pending = false;
+            _pending_count--;
+            update( outline.dirty_rect );
+        }
+    }
+}
+
+void StatusOverlayItem::clearStyles()
+{
+    for (size_t index = 0; index < _outlines.size() && _outlines_count > 0; index++)
+    {
+        setStyle( index, nullptr );
+    }
+}
+
+QRectF StatusOverlayItem::boundingRect() const
+{
+    return _bounding_rect;
+}
+
+QPainterPath StatusOverlayItem::shape() const
+{
+    return QPainterPath();
+}
+
+void StatusOverlayItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*)
+{
+    if( _outlines_count == 0 )
+    {
+        return;
+    }
+    painter->setBrush( Qt::NoBrush );
+
+    for (const Outline& outline: _outlines)
+    {
+        if( !outline.style || !outline.dirty_rect.intersects( option->exposedRect ) )
+        {
+            continue;
+        }
+        const auto& conn_style = *outline.style->connection;
+        const auto& node_style = *outline.style->node;
+
+        if( !outline.connection.isEmpty() )
+        {
+            painter->setPen( QPen( conn_style.normalColor(), conn_style.lineWidth() ) );
+            painter->drawPath( outline.connection );
+        }
+        painter->setPen( QPen( node_style.NormalBoundaryColor, node_style.PenWidth ) );
+        painter->drawRoundedRect( outline.rect, 3.0, 3.0 );
+    }
+}
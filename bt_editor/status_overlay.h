@@ -0,0 +1,80 @@
+#ifndef STATUS_OVERLAY_H
+#define STATUS_OVERLAY_H
+
+#include <QGraphicsItem>
+#include <QPainterPath>
+#include <vector>
+#include <nodes/Node>
+
+#include "utils.h"
+
+// Draws the status outlines of the nodes (and of the connections with their
+// parents) of the monitor and replay modes, on top of the whole scene.
+//
+// The nodes are never restyled: their DeviceCoordinateCache stays valid, and a
+// status change repaints only the area of that outline. Outlines outside of the
+// visible area are not repainted at all: only their latest style is recorded, and
+// they are repainted when the visible area reaches them.
+class StatusOverlayItem : public QGraphicsItem
+{
+public:
+    enum { Type = UserType + 1 };
+
+    StatusOverlayItem();
+
+    // geometry of the outlines, one for each index of BuildTreeFromScene.
+    // Styles are kept if the number of nodes doesn't change.
+    void setNodes(const std::vector<QtNodes::Node*>& nodes);
+
+    size_t size() const { return _outlines.size(); }
+
+    // nullptr, or a style without outline, removes the outline
+    void setStyle(size_t index, const SharedNodeStyle* style);
+
+    const SharedNodeStyle* style(size_t index) const { return _outlines.at(index).style; }
+
+    void clearStyles();
+
+    // nodes with an outline
+    size_t outlinesCount() const { return _outlines_count; }
+
+    // Area of the scene shown by the view; empty when the view is hidden.
+    // Until it is set, every outline is considered visible.
+    void setVisibleRect(const QRectF& rect);
+
+    // outlines whose style changed while outside of the visible area
+    size_t pendingCount() const { return _pending_count; }
+
+    // rectangle of the node and path of the connection with its parent, in scene coordinates
+    static void nodeOutline(QtNodes::Node& node, QRectF& rect, QPainterPath& connection);
+
+    QRectF boundingRect() const override;
+
+    // empty: the overlay never receives mouse events
+    QPainterPath shape() const override;
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    int type() const override { return Type; }
+
+private:
+    struct Outline
+    {
+        QRectF rect;
+        QPainterPath connection;
+        // area repainted when the style changes
+        QRectF dirty_rect;
+        const SharedNodeStyle* style;
+        bool pending;
+    };
+
+    std::vector<Outline> _outlines;
+    QRectF _bounding_rect;
+    size_t _outlines_count;
+
+    QRectF _visible_rect;
+    bool _has_visible_rect;
+    size_t _pending_count;
+};
+
+#endif // STATUS_OVERLAY_H
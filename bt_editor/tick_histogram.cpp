@@ -0,0 +1,82 @@
+#include "tick_histogram.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <algorithm>
+
+TickHistogram::TickHistogram(QWidget *parent) : QWidget(parent)
+{
+    setMinimumHeight(80);
+    setCursor( Qt::PointingHandCursor );
+}
+
+void TickHistogram::setStatistics(const TickStatistics &stats)
+{
+    _stats = stats;
+    update();
+}
+
+QRectF TickHistogram::plotArea() const
+{
+    return QRectF( 4, 14, width() - 8, height() - 18 );
+}
+
+void TickHistogram::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect( rect(), QColor::fromRgb(255, 255, 255) );
+
+    const QRectF area = plotArea();
+    painter.setPen( QColor::fromRgb(180, 180, 180) );
+    painter.drawLine( area.bottomLeft(), area.bottomRight() );
+
+    if( _stats.histogram.empty() )
+    {
+        return;
+    }
+
+    const int max_count = *std::max_element( _stats.histogram.begin(), _stats.histogram.end() );
+    const double bar_width = area.width() / _stats.histogram.size();
+
+    painter.setPen( Qt::NoPen );
+    painter.setBrush( QColor::fromRgb(250, 160, 20) );
+
+    for (size_t bin = 0; bin < _stats.histogram.size(); bin++)
+    {
+        const int count = _stats.histogram[bin];
+        if( count == 0 ) continue;
+        // keep non-empty bins visible, the slow outliers are the interesting ones
+        const double bar_height = std::max( 2.0, area.height() * count / max_count );
+        painter.drawRect( QRectF( area.left() + bin*bar_width,
+                                  area.bottom() - bar_height,
+                                  bar_width - 1, bar_height ) );
+    }
+
+    if( _stats.max <= 0 )
+    {
+        return;
+    }
+
+    auto drawMarker = [&](double value, const QColor& color, const QString& label)
+    {
+        const double x = area.left() + area.width() * (value / _stats.max);
+        painter.setPen( QPen(color, 1, Qt::DashLine) );
+        painter.drawLine( QPointF(x, area.top()), QPointF(x, area.bottom()) );
+        painter.drawText( QPointF( std::min(x + 2, area.right() - 30), area.top() - 2), label );
+    };
+
+    drawMarker( _stats.p50, QColor::fromRgb(51, 200, 51),  "p50" );
+    drawMarker( _stats.p99, QColor::fromRgb(250, 50, 50),  "p99" );
+    drawMarker( _stats.max, QColor::fromRgb(80, 80, 80),   "max" );
+}
+
+void TickHistogram::mousePressEvent(QMouseEvent *event)
+{
+    const QRectF area = plotArea();
+    if( _stats.histogram.empty() || !area.contains( event->pos() ) )
+    {
+        return;
+    }
+    int bin = static_cast<int>( (event->pos().x() - area.left()) * _stats.histogram.size() / area.width() );
+    bin = std::min( bin, static_cast<int>(_stats.histogram.size()) -1 );
+    emit binClicked( std::max(0, bin) );
+}
@@ -0,0 +1,32 @@
+#ifndef TICK_HISTOGRAM_H
+#define TICK_HISTOGRAM_H
+
+#include <QWidget>
+#include "replay_log.h"
+
+class TickHistogram : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TickHistogram(QWidget *parent = nullptr);
+
+    void setStatistics(const TickStatistics& stats);
+
+    QSize sizeHint() const override { return QSize(200, 100); }
+
+signals:
+    void binClicked(int bin);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+    void mousePressEvent(QMouseEvent *event) override;
+
+private:
+    TickStatistics _stats;
+
+    QRectF plotArea() const;
+};
+
+#endif // TICK_HISTOGRAM_H
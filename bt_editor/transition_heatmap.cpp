@@ -0,0 +1,62 @@
+#include "transition_heatmap.h"
+#include <algorithm>
+#include <cmath>
+
+constexpr double TransitionHeatmap::MIN_RATE;
+constexpr double TransitionHeatmap::MAX_RATE;
+constexpr int TransitionHeatmap::LEVEL_STEPS;
+
+TransitionHeatmap::TransitionHeatmap(double time_constant):
+    _time_constant(time_constant)
+{
+}
+
+void TransitionHeatmap::reset(size_t nodes_count)
+{
+    _nodes.assign( nodes_count, {0.0, 0.0} );
+}
+
+void TransitionHeatmap::addTransition(size_t index, double time)
+{
+    if( index >= _nodes.size() )
+    {
+        return;
+    }
+    Entry& node = _nodes[index];
+    // several transitions of the same message have the same time: no decay
+    if( time > node.last_time )
+    {
+        node.rate *= std::exp( (node.last_time - time) / _time_constant );
+        node.last_time = time;
+    }
+    node.rate += 1.0 / _time_constant;
+}
+
+double TransitionHeatmap::rate(size_t index, double time) const
+{
+    if( index >= _nodes.size() )
+    {
+        return 0;
+    }
+    const Entry& node = _nodes[index];
+    if( time <= node.last_time )
+    {
+        return node.rate;
+    }
+    return node.rate * std::exp( (node.last_time - time) / _time_constant );
+}
+
+double TransitionHeatmap::level(double rate)
+{
+    if( rate <= MIN_RATE )
+    {
+        return 0;
+    }
+    const double value = std::log10( rate / MIN_RATE ) / std::log10( MAX_RATE / MIN_RATE );
+    return std::min( 1.0, value );
+}
+
+int TransitionHeatmap::levelStep(double rate)
+{
+    return static_cast<int>( std::ceil( level(rate) * LEVEL_STEPS ) );
+}
@@ -0,0 +1,46 @@
+#ifndef TRANSITION_HEATMAP_H
+#define TRANSITION_HEATMAP_H
+
+#include <vector>
+#include <cstddef>
+
+// Transitions per second of each node, as an exponentially decayed average:
+// every transition adds 1/time_constant to the rate of its node, that decays
+// with exp(-dt/time_constant). Constant time and memory per transition.
+class TransitionHeatmap
+{
+public:
+    explicit TransitionHeatmap(double time_constant = 5.0);
+
+    void reset(size_t nodes_count);
+
+    // time in seconds; it must not go backward
+    void addTransition(size_t index, double time);
+
+    // transitions per second at the given time
+    double rate(size_t index, double time) const;
+
+    // log scale: 0 for MIN_RATE (or less), 1 for MAX_RATE (or more)
+    static double level(double rate);
+
+    static constexpr double MIN_RATE = 0.01;
+    static constexpr double MAX_RATE = 1000.0;
+
+    // steps of the color ramp: level() * LEVEL_STEPS, rounded up
+    static constexpr int LEVEL_STEPS = 32;
+
+    static int levelStep(double rate);
+
+    size_t size() const { return _nodes.size(); }
+
+private:
+    struct Entry
+    {
+        double rate;
+        double last_time;
+    };
+    double _time_constant;
+    std::vector<Entry> _nodes;
+};
+
+#endif // TRANSITION_HEATMAP_H
@@ -0,0 +1,368 @@
+#include "tree_sandbox.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <behaviortree_cpp_v3/loggers/abstract_logger.h>
+#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+
+#include "monitor_protocol.h"
+
+// transitions of a tick, in the format of a .fbl file
+class SandboxLogger : public BT::StatusChangeLogger
+{
+public:
+    SandboxLogger(BT::TreeNode* root_node): BT::StatusChangeLogger(root_node) {}
+
+    void callback(BT::Duration, const BT::TreeNode& node,
+                  BT::NodeStatus prev_status, BT::NodeStatus status) override
+    {
+        // the monitor compares the timestamps with the system clock
+        const auto usec_total = std::chrono::duration_cast<std::chrono::microseconds>(
+                                    std::chrono::system_clock::now().time_since_epoch() ).count();
+        const uint32_t sec  = static_cast<uint32_t>( usec_total / 1000000 );
+        const uint32_t usec = static_cast<uint32_t>( usec_total % 1000000 );
+        const uint16_t uid = node.UID();
+
+        char transition[MONITOR_TRANSITION_SIZE];
+        std::memcpy( &transition[0], &sec, 4 );
+        std::memcpy( &transition[4], &usec, 4 );
+        std::memcpy( &transition[8], &uid, 2 );
+        transition[10] = static_cast<char>( prev_status );
+        transition[11] = static_cast<char>( status );
+        buffer.append( transition, MONITOR_TRANSITION_SIZE );
+    }
+
+    void flush() override {}
+
+    size_t count() const { return buffer.size() / MONITOR_TRANSITION_SIZE; }
+
+    std::string buffer;
+};
+
+namespace {
+
+// outcomes and latencies of the dummy nodes; used only by the thread ticking the tree
+class SandboxBehavior
+{
+public:
+    SandboxBehavior(const SandboxOptions& options):
+        _options(options),
+        _random(options.seed),
+        _uniform(0.0, 1.0)
+    {}
+
+    const std::string* script(const std::string& ID) const
+    {
+        auto it = _options.scripts.find( ID );
+        return ( it != _options.scripts.end() && !it->second.empty() ) ? &it->second : nullptr;
+    }
+
+    BT::NodeStatus outcome(const std::string* script, size_t& cursor)
+    {
+        if( script )
+        {
+            const char result = (*script)[ cursor++ % script->size() ];
+            return ( result == 'F' || result == 'f' ) ? BT::NodeStatus::FAILURE :
+                                                        BT::NodeStatus::SUCCESS;
+        }
+        return ( _uniform(_random) < _options.success_probability ) ? BT::NodeStatus::SUCCESS :
+                                                                      BT::NodeStatus::FAILURE;
+    }
+
+    std::chrono::steady_clock::duration latency()
+    {
+        const double seconds = _options.min_latency +
+                               _uniform(_random) * ( _options.max_latency - _options.min_latency );
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>( std::max( 0.0, seconds ) ) );
+    }
+
+private:
+    SandboxOptions _options;
+    std::mt19937 _random;
+    std::uniform_real_distribution<double> _uniform;
+};
+
+class SandboxAction : public BT::ActionNodeBase
+{
+public:
+    SandboxAction(const std::string& name, const BT::NodeConfiguration& config,
+                  const std::string& ID, std::shared_ptr<SandboxBehavior> behavior):
+        BT::ActionNodeBase(name, config),
+        _behavior( std::move(behavior) ),
+        _script( _behavior->script(ID) ),
+        _cursor(0)
+    {}
+
+    BT::NodeStatus tick() override
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if( status() != BT::NodeStatus::RUNNING )
+        {
+            _deadline = now + _behavior->latency();
+        }
+        if( now < _deadline )
+        {
+            return BT::NodeStatus::RUNNING;
+        }
+        return _behavior->outcome( _script, _cursor );
+    }
+
+    void halt() override
+    {
+        setStatus( BT::NodeStatus::IDLE );
+    }
+
+private:
+    std::shared_ptr<SandboxBehavior> _behavior;
+    const std::string* _script;
+    size_t _cursor;
+    std::chrono::steady_clock::time_point _deadline;
+};
+
+class SandboxCondition : public BT::ConditionNode
+{
+public:
+    SandboxCondition(const std::string& name, const BT::NodeConfiguration& config,
+                     const std::string& ID, std::shared_ptr<SandboxBehavior> behavior):
+        BT::ConditionNode(name, config),
+        _behavior( std::move(behavior) ),
+        _script( _behavior->script(ID) ),
+        _cursor(0)
+    {}
+
+    BT::NodeStatus tick() override
+    {
+        return _behavior->outcome( _script, _cursor );
+    }
+
+private:
+    std::shared_ptr<SandboxBehavior> _behavior;
+    const std::string* _script;
+    size_t _cursor;
+};
+
+class SandboxDecorator : public BT::DecoratorNode
+{
+public:
+    SandboxDecorator(const std::string& name, const BT::NodeConfiguration& config):
+        BT::DecoratorNode(name, config)
+    {}
+
+    BT::NodeStatus tick() override
+    {
+        setStatus( BT::NodeStatus::RUNNING );
+        return child_node_->executeTick();
+    }
+};
+
+class SandboxControl : public BT::ControlNode
+{
+public:
+    SandboxControl(const std::string& name, const BT::NodeConfiguration& config):
+        BT::ControlNode(name, config),
+        _current(0)
+    {}
+
+    BT::NodeStatus tick() override
+    {
+        setStatus( BT::NodeStatus::RUNNING );
+        while( _current < children_nodes_.size() )
+        {
+            const BT::NodeStatus child_status = children_nodes_[_current]->executeTick();
+            if( child_status == BT::NodeStatus::RUNNING )
+            {
+                return child_status;
+            }
+            if( child_status == BT::NodeStatus::FAILURE )
+            {
+                resetChildren();
+                return child_status;
+            }
+            _current++;
+        }
+        resetChildren();
+        return BT::NodeStatus::SUCCESS;
+    }
+
+    void halt() override
+    {
+        _current = 0;
+        BT::ControlNode::halt();
+    }
+
+private:
+    // like ControlNode::haltChildren, whose signature changed in the 3.x releases
+    void resetChildren()
+    {
+        for (BT::TreeNode* child: children_nodes_)
+        {
+            if( child->status() == BT::NodeStatus::RUNNING )
+            {
+                child->halt();
+            }
+            child->setStatus( BT::NodeStatus::IDLE );
+        }
+        _current = 0;
+    }
+
+    size_t _current;
+};
+
+void RegisterDummy(BT::BehaviorTreeFactory& factory, const NodeModel& model,
+                   const std::shared_ptr<SandboxBehavior>& behavior)
+{
+    BT::TreeNodeManifest manifest;
+    manifest.type = model.type;
+    manifest.registration_ID = model.registration_ID.toStdString();
+    for (const auto& port_it: model.ports)
+    {
+        manifest.ports.insert( { port_it.first.toStdString(), BT::PortInfo( port_it.second.direction ) } );
+    }
+
+    const std::string ID = manifest.registration_ID;
+    BT::NodeBuilder builder;
+    switch( model.type )
+    {
+    case NodeType::ACTION:
+        builder = [ID, behavior](const std::string& name, const BT::NodeConfiguration& config)
+        {
+            return std::unique_ptr<BT::TreeNode>( new SandboxAction(name, config, ID, behavior) );
+        };
+        break;
+    case NodeType::CONDITION:
+        builder = [ID, behavior](const std::string& name, const BT::NodeConfiguration& config)
+        {
+            return std::unique_ptr<BT::TreeNode>( new SandboxCondition(name, config, ID, behavior) );
+        };
+        break;
+    case NodeType::DECORATOR:
+        builder = [](const std::string& name, const BT::NodeConfiguration& config)
+        {
+            return std::unique_ptr<BT::TreeNode>( new SandboxDecorator(name, config) );
+        };
+        break;
+    case NodeType::CONTROL:
+        builder = [](const std::string& name, const BT::NodeConfiguration& config)
+        {
+            return std::unique_ptr<BT::TreeNode>( new SandboxControl(name, config) );
+        };
+        break;
+    default:
+        // subtrees are instantiated by the factory from the XML
+        return;
+    }
+    factory.registerBuilder( manifest, builder );
+}
+
+}
+
+TreeSandbox::TreeSandbox(zmq::context_t& context,
+                         const std::string& address_pub,
+                         const std::string& address_rep):
+    _publisher( context, address_pub, address_rep ),
+    _running(false),
+    _ticks(0),
+    _transitions(0)
+{
+}
+
+TreeSandbox::~TreeSandbox()
+{
+    stop();
+}
+
+void TreeSandbox::start(const QString& xml_text, const NodeModels& models, const SandboxOptions& options)
+{
+    stop();
+
+    auto behavior = std::make_shared<SandboxBehavior>( options );
+    BT::BehaviorTreeFactory factory;
+    for (const auto& it: models)
+    {
+        const NodeModel& model = *it.second;
+        if( model.registration_ID == "Root" ||
+            factory.manifests().count( model.registration_ID.toStdString() ) != 0 )
+        {
+            continue;
+        }
+        RegisterDummy( factory, model, behavior );
+    }
+
+    try{
+        _tree.reset( new BT::Tree( factory.createTreeFromText( xml_text.toStdString() ) ) );
+    }
+    catch( std::exception& err )
+    {
+        throw std::runtime_error( std::string("Can't create the tree: ") + err.what() );
+    }
+    if( !_tree->rootNode() )
+    {
+        _tree.reset();
+        throw std::runtime_error( "Can't create the tree: it is empty" );
+    }
+
+    flatbuffers::FlatBufferBuilder builder(1024);
+    BT::CreateFlatbuffersBehaviorTree( builder, *_tree );
+    _publisher.setTree( std::string( reinterpret_cast<const char*>( builder.GetBufferPointer() ),
+                                     builder.GetSize() ) );
+
+    _logger.reset( new SandboxLogger( _tree->rootNode() ) );
+    _ticks = 0;
+    _transitions = 0;
+    _running = true;
+    _thread = std::thread( &TreeSandbox::tickLoop, this, options.tick_rate );
+}
+
+void TreeSandbox::stop()
+{
+    _running = false;
+    if( _thread.joinable() )
+    {
+        _thread.join();
+    }
+    // the tree halts its nodes when destroyed: nobody must be listening
+    _logger.reset();
+    _tree.reset();
+}
+
+void TreeSandbox::tickLoop(double tick_rate)
+{
+    BT::TreeNode* root = _tree->rootNode();
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>( tick_rate > 0 ? 1.0 / tick_rate : 0.0 ) );
+    auto next = std::chrono::steady_clock::now();
+
+    while( _running )
+    {
+        const BT::NodeStatus status = root->executeTick();
+        if( status != BT::NodeStatus::RUNNING )
+        {
+            // like a robot ticking the tree again, from IDLE
+            root->halt();
+            root->setStatus( BT::NodeStatus::IDLE );
+        }
+        _ticks++;
+
+        if( _logger->count() > 0 )
+        {
+            _publisher.publish( _logger->buffer.data(), _logger->count() );
+            _transitions += _logger->count();
+            _logger->buffer.clear();
+        }
+
+        if( period.count() > 0 )
+        {
+            next += period;
+            const auto now = std::chrono::steady_clock::now();
+            if( next < now )
+            {
+                // too slow for the requested rate: don't try to catch up
+                next = now;
+            }
+            std::this_thread::sleep_until( next );
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef TREE_SANDBOX_H
+#define TREE_SANDBOX_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <zmq.hpp>
+
+#include "bt_editor_base.h"
+#include "monitor_publisher.h"
+
+struct SandboxOptions
+{
+    SandboxOptions(): tick_rate(100), success_probability(0.8),
+        min_latency(0), max_latency(0), seed(0) {}
+
+    // ticks of the root per second; 0 is as fast as possible
+    double tick_rate;
+    // probability of SUCCESS of the dummy actions and conditions
+    double success_probability;
+    // the dummy actions stay RUNNING for a random time in this range (seconds)
+    double min_latency;
+    double max_latency;
+    unsigned seed;
+    // scripted outcomes, by registration ID: a sequence of 'S' (success) and
+    // 'F' (failure), repeated. Each instance of the node has its own cursor.
+    std::map<std::string, std::string> scripts;
+};
+
+class SandboxLogger;
+
+// Runs the tree of the editor in this process, to use the monitor without a robot.
+// The nodes that aren't builtin are replaced by dummies: actions and conditions
+// with random (or scripted) outcomes and latencies, decorators that return the
+// status of their child and controls that behave like a Sequence.
+// A thread ticks the root and publishes the transitions of each tick as a single
+// message of a MonitorPublisher; the monitor connects to it like to a robot.
+class TreeSandbox
+{
+public:
+    // Binds both sockets, usually inproc:// addresses of the context of
+    // the monitor. Throws zmq::error_t.
+    TreeSandbox(zmq::context_t& context,
+                const std::string& address_pub,
+                const std::string& address_rep);
+
+    ~TreeSandbox();
+
+    // xml_text is a document like the one of MainWindow::saveToXML(); models
+    // are those of the nodes of the tree (the builtin ones are skipped).
+    // Stops the previous tree. Throws std::runtime_error if the tree can't be created.
+    void start(const QString& xml_text, const NodeModels& models, const SandboxOptions& options);
+
+    void stop();
+
+    bool isRunning() const { return _thread.joinable(); }
+
+    uint64_t ticksCount() const { return _ticks; }
+
+    uint64_t transitionsCount() const { return _transitions; }
+
+    const MonitorPublisher& publisher() const { return _publisher; }
+
+private:
+    void tickLoop(double tick_rate);
+
+    MonitorPublisher _publisher;
+    std::unique_ptr<BT::Tree> _tree;
+    std::unique_ptr<SandboxLogger> _logger;
+
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::atomic<uint64_t> _ticks;
+    std::atomic<uint64_t> _transitions;
+};
+
+#endif // TREE_SANDBOX_H
@@ -1,5 +1,7 @@
 #include "utils.h"
 #include <set>
+#include <algorithm>
+#include <cmath>
 #include <QDebug>
 #include <QDomDocument>
 #include <QMessageBox>
@@ -8,6 +10,7 @@
 #include "nodes/internal/memory.hpp"
 #include "models/SubtreeNodeModel.hpp"
 #include "models/RootNodeModel.hpp"
+#include "transition_heatmap.h"
 
 using QtNodes::PortLayout;
 using QtNodes::DataModelRegistry;
@@ -391,10 +394,17 @@ BuildTreeFromFlatbuffers(const Serialization::BehaviorTree *fb_behavior_tree)
     AbsBehaviorTree tree;
     std::unordered_map<int, int> uid_to_index;
 
+    static const NodeModelPtr root_model = []()
+    {
+        NodeModel model;
+        model.type = NodeType::UNDEFINED;
+        model.registration_ID = "Root";
+        return MakeNodeModel( std::move(model) );
+    }();
+
     AbstractTreeNode abs_root;
     abs_root.instance_name = "Root";
-    abs_root.model.registration_ID = "Root";
-    abs_root.model.registration_ID = "Root";
+    abs_root.model = root_model;
     abs_root.children_index.push_back( 1 );
 
     tree.addNode( nullptr, std::move(abs_root) );
@@ -419,7 +429,8 @@ BuildTreeFromFlatbuffers(const Serialization::BehaviorTree *fb_behavior_tree)
             model.ports.insert( { port_name, std::move(port_model) } );
         }
 
-        models.insert( { model.registration_ID, std::move(model)} );
+        const QString ID = model.registration_ID;
+        models.insert( { ID, MakeNodeModel( std::move(model) ) } );
     }
 
     //-----------------------------------------
@@ -429,7 +440,7 @@ BuildTreeFromFlatbuffers(const Serialization::BehaviorTree *fb_behavior_tree)
         abs_node.instance_name = fb_node->instance_name()->c_str();
         const char* registration_ID = fb_node->registration_name()->c_str();
         abs_node.status = convert( fb_node->status() );
-        abs_node.model = (models.at(registration_ID));
+        abs_node.model = models.at(registration_ID);
 
         for( const Serialization::PortConfig* pair: *(fb_node->port_remaps()) )
         {
@@ -455,8 +466,10 @@ BuildTreeFromFlatbuffers(const Serialization::BehaviorTree *fb_behavior_tree)
     return { tree, uid_to_index };
 }
 
+namespace {
+
 std::pair<QtNodes::NodeStyle, QtNodes::ConnectionStyle>
-getStyleFromStatus(NodeStatus status, NodeStatus prev_status)
+createStatusStyle(NodeStatus status, NodeStatus prev_status)
 {
     QtNodes::NodeStyle  node_style;
     QtNodes::ConnectionStyle conn_style;
@@ -522,6 +535,84 @@ getStyleFromStatus(NodeStatus status, NodeStatus prev_status)
     return {node_style, conn_style};
 }
 
+std::pair<QtNodes::NodeStyle, QtNodes::ConnectionStyle>
+createHeatStyle(double level)
+{
+    QtNodes::NodeStyle  node_style;
+    QtNodes::ConnectionStyle conn_style;
+    conn_style.HoveredColor = Qt::transparent;
+
+    if( level <= 0.0 )
+    {
+        return {node_style, conn_style};
+    }
+    level = std::min( level, 1.0 );
+
+    // hue goes from blue (cold) to red (hot); the pen grows with the level
+    node_style.PenWidth *= 1.0 + 3.0 * level;
+    node_style.HoveredPenWidth = node_style.PenWidth;
+    node_style.NormalBoundaryColor =
+            node_style.ShadowColor = QColor::fromHsvF( 0.66 * (1.0 - level), 0.9, 0.95 );
+    conn_style.NormalColor = node_style.NormalBoundaryColor;
+
+    return {node_style, conn_style};
+}
+
+SharedNodeStyle makeShared(std::pair<QtNodes::NodeStyle, QtNodes::ConnectionStyle>&& style, bool outline)
+{
+    return { std::make_shared<const QtNodes::NodeStyle>( std::move(style.first) ),
+             std::make_shared<const QtNodes::ConnectionStyle>( std::move(style.second) ),
+             outline };
+}
+
+// IDLE, RUNNING, SUCCESS and FAILURE
+const int STATUS_COUNT = 4;
+
+int statusSlot(NodeStatus status)
+{
+    const int value = static_cast<int>(status);
+    return ( value >= 0 && value < STATUS_COUNT ) ? value : 0;
+}
+
+}
+
+const SharedNodeStyle&
+getStyleFromStatus(NodeStatus status, NodeStatus prev_status)
+{
+    static const std::vector<SharedNodeStyle> palette = []()
+    {
+        std::vector<SharedNodeStyle> styles;
+        for (int s = 0; s < STATUS_COUNT; s++)
+        {
+            for (int prev = 0; prev < STATUS_COUNT; prev++)
+            {
+                styles.push_back( makeShared( createStatusStyle( static_cast<NodeStatus>(s),
+                                                                 static_cast<NodeStatus>(prev) ),
+                                              s != 0 || prev != 0 ) );
+            }
+        }
+        return styles;
+    }();
+    return palette[ statusSlot(status) * STATUS_COUNT + statusSlot(prev_status) ];
+}
+
+const SharedNodeStyle&
+getStyleFromHeat(double level)
+{
+    static const std::vector<SharedNodeStyle> palette = []()
+    {
+        std::vector<SharedNodeStyle> styles;
+        for (int step = 0; step <= TransitionHeatmap::LEVEL_STEPS; step++)
+        {
+            styles.push_back( makeShared( createHeatStyle( double(step) / TransitionHeatmap::LEVEL_STEPS ),
+                                          step > 0 ) );
+        }
+        return styles;
+    }();
+    const double clamped = std::max( 0.0, std::min( level, 1.0 ) );
+    return palette[ static_cast<int>( std::round( clamped * TransitionHeatmap::LEVEL_STEPS ) ) ];
+}
+
 QtNodes::Node *GetParentNode(QtNodes::Node *node)
 {
     using namespace QtNodes;
@@ -5,6 +5,8 @@
 #include <nodes/NodeData>
 #include <nodes/FlowScene>
 #include <nodes/NodeStyle>
+#include <nodes/ConnectionStyle>
+#include <memory>
 
 #include "bt_editor_base.h"
 #include <behaviortree_cpp_v3/flatbuffers/BT_logger_generated.h>
@@ -26,9 +28,24 @@ AbsBehaviorTree BuildTreeFromXML(const QDomElement &bt_root, const NodeModels &m
 
 void NodeReorder(QtNodes::FlowScene &scene, AbsBehaviorTree &abstract_tree );
 
-std::pair<QtNodes::NodeStyle, QtNodes::ConnectionStyle>
+// Immutable styles, referenced by the nodes and connections instead of copied.
+struct SharedNodeStyle
+{
+    std::shared_ptr<const QtNodes::NodeStyle> node;
+    std::shared_ptr<const QtNodes::ConnectionStyle> connection;
+    // false if it looks like the default style: there is no status outline to draw
+    bool outline;
+};
+
+// entry of a palette built once, with all the combinations of status and prev_status
+const SharedNodeStyle&
 getStyleFromStatus(NodeStatus status, NodeStatus prev_status);
 
+// level in [0,1], from cold (blue) to hot (red). Level 0 is the default style.
+// Quantized to TransitionHeatmap::LEVEL_STEPS entries of a palette.
+const SharedNodeStyle&
+getStyleFromHeat(double level);
+
 QtNodes::Node* GetParentNode(QtNodes::Node* node);
 
 std::set<QString> GetModelsToRemove(QWidget* parent,
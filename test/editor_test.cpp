@@ -27,6 +27,9 @@ private slots:
     void longNames();
     void clearModels();
     void undoWithSubtreeExpanded();
+    void sharedModels();
+    void structuralHash();
+    void containerTree();
 };
 
 
@@ -445,7 +448,7 @@ void EditorTest::modifyCustomModel()
                              { {"UseParachute", PortModel() } }
     };
 
-    sidepanel_editor->onReplaceModel("PassThroughWindow", jump_model);
+    sidepanel_editor->onReplaceModel("PassThroughWindow", MakeNodeModel(jump_model) );
 
     auto pass_window_items = treeWidget->findItems("PassThroughWindow",
                                                    Qt::MatchExactly | Qt::MatchRecursive);
@@ -460,7 +463,7 @@ void EditorTest::modifyCustomModel()
     auto jump_abs_node = abs_tree.findFirstNode( jump_model.registration_ID );
     QVERIFY( jump_abs_node != nullptr);
     sleepAndRefresh( 500 );
-    QCOMPARE( jump_abs_node->model, jump_model );
+    QCOMPARE( *jump_abs_node->model, jump_model );
 
     sleepAndRefresh( 500 );
 }
@@ -560,12 +563,12 @@ void EditorTest::longNames()
     auto abs_tree = getAbstractTree();
     QCOMPARE( abs_tree.nodesCount(), size_t(4) );
     auto sequence = abs_tree.node(1);
-    QCOMPARE( sequence->model.registration_ID, QString("Sequence"));
+    QCOMPARE( sequence->model->registration_ID, QString("Sequence"));
 
     // second child on the right side.
     int short_index = sequence->children_index[1];
     auto short_node = abs_tree.node(short_index);
-    QCOMPARE( short_node->model.registration_ID, QString("short") );
+    QCOMPARE( short_node->model->registration_ID, QString("short") );
 }
 
 void EditorTest::clearModels()
@@ -633,6 +636,145 @@ void EditorTest::undoWithSubtreeExpanded()
      sleepAndRefresh( 500 );
 }
 
+void EditorTest::sharedModels()
+{
+    QString file_xml = readFile(":/crossdoor_with_subtree.xml");
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( file_xml );
+
+    const auto& models = main_win->registeredModels();
+
+    // the nodes of the tree point to the models of the registry
+    auto abs_tree = getAbstractTree("MainTree");
+    for (const auto& node: abs_tree.nodes())
+    {
+        auto it = models.find( node.model->registration_ID );
+        if( it != models.end() )
+        {
+            QCOMPARE( node.model.get(), it->second.get() );
+        }
+    }
+    auto copy_tree = abs_tree;
+    QCOMPARE( copy_tree.node(1)->model.get(), abs_tree.node(1)->model.get() );
+
+    // equal strings share the same buffer
+    const QString name_A = InternString( QString("PassThroughWindow") );
+    const QString name_B = InternString( QString("PassThrough") + QString("Window") );
+    QCOMPARE( name_A.constData(), name_B.constData() );
+    QCOMPARE( models.at("PassThroughWindow")->registration_ID.constData(), name_A.constData() );
+
+    // only the names are interned, not the free text of the ports
+    auto makeModel = []()
+    {
+        NodeModel model;
+        model.type = NodeType::ACTION;
+        model.registration_ID = QString("Intern") + QString("Test");
+        PortModel port;
+        port.type_name = QString("std::") + QString("string");
+        port.description = QString("any ") + QString("description");
+        model.ports.insert( { QString("target") + QString("_pose"), port } );
+        return MakeNodeModel( model );
+    };
+    auto model_A = makeModel();
+    auto model_B = makeModel();
+    const auto& port_A = *model_A->ports.begin();
+    const auto& port_B = *model_B->ports.begin();
+    QCOMPARE( model_A->registration_ID.constData(), model_B->registration_ID.constData() );
+    QCOMPARE( port_A.first.constData(), port_B.first.constData() );
+    QCOMPARE( port_A.second.type_name.constData(), port_B.second.type_name.constData() );
+    QVERIFY( port_A.second.description.constData() != port_B.second.description.constData() );
+}
+
+void EditorTest::structuralHash()
+{
+    QString file_xml = readFile(":/crossdoor_with_subtree.xml");
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( file_xml );
+
+    auto main_tree   = getAbstractTree("MainTree");
+    auto closed_tree = getAbstractTree("DoorClosed");
+
+    // the same subtree in different trees
+    auto main_condition   = main_tree.findFirstNode("IsDoorOpen");
+    auto closed_condition = closed_tree.findFirstNode("IsDoorOpen");
+    QVERIFY( main_condition && closed_condition );
+    QCOMPARE( main_tree.structuralHash( main_condition->index ),
+              closed_tree.structuralHash( closed_condition->index ) );
+    QVERIFY( main_tree.structuralHash() != closed_tree.structuralHash() );
+
+    // the status is not part of the structure, but trees with another status differ
+    auto copy_tree = main_tree;
+    QVERIFY( copy_tree == main_tree );
+    QVERIFY( copy_tree.sameStructure( main_tree ) );
+    copy_tree.rootNode()->status = NodeStatus::RUNNING;
+    QVERIFY( copy_tree != main_tree );
+    QVERIFY( copy_tree.sameStructure( main_tree ) );
+
+    // a change is propagated to the ancestors only, also through a pointer
+    // taken before the hashes were computed
+    const int window_index = main_tree.findFirstNode("PassThroughWindow")->index;
+    const int door_index   = main_tree.findFirstNode("door_open_sequence")->index;
+    AbstractTreeNode* window_node = copy_tree.node( window_index );
+    QCOMPARE( copy_tree.structuralHash(), main_tree.structuralHash() );
+    window_node->instance_name = "JumpThroughWindow";
+
+    QVERIFY( !copy_tree.sameStructure( main_tree ) );
+    QVERIFY( copy_tree.structuralHash() != main_tree.structuralHash() );
+    QVERIFY( copy_tree.structuralHash( window_index ) != main_tree.structuralHash( window_index ) );
+    QCOMPARE( copy_tree.structuralHash( door_index ), main_tree.structuralHash( door_index ) );
+}
+
+void EditorTest::containerTree()
+{
+    QString file_xml = readFile(":/crossdoor_with_subtree.xml");
+    main_win->on_actionClear_triggered();
+    main_win->loadFromXML( file_xml );
+
+    auto container = main_win->getTabByName("MainTree");
+    auto scene = container->scene();
+
+    auto sameOfScene = [&]() -> bool
+    {
+        const auto& tree = container->tree();
+        auto scene_tree = getAbstractTree("MainTree");
+        if( tree != scene_tree ) return false;
+        for (size_t index = 0; index < tree.nodesCount(); index++)
+        {
+            if( tree.node(index)->graphic_node != scene_tree.node(index)->graphic_node ||
+                tree.node(index)->pos != scene_tree.node(index)->pos ||
+                tree.node(index)->size != scene_tree.node(index)->size )
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    QVERIFY( sameOfScene() );
+
+    auto abs_tree = getAbstractTree("MainTree");
+    auto window_node = abs_tree.findFirstNode("PassThroughWindow")->graphic_node;
+    auto door_node   = abs_tree.findFirstNode("door_open_sequence")->graphic_node;
+
+    // updated in place
+    auto window_model = dynamic_cast<BehaviorTreeDataModel*>( window_node->nodeDataModel() );
+    window_model->setInstanceName("JumpThroughWindow");
+    QVERIFY( container->tree().nodes()[ abs_tree.findFirstNode("PassThroughWindow")->index ].instance_name ==
+             "JumpThroughWindow" );
+    QVERIFY( sameOfScene() );
+
+    // the first child becomes the last one
+    const QPointF window_pos = scene->getNodePosition( *window_node );
+    const QPointF door_pos   = scene->getNodePosition( *door_node );
+    scene->setNodePosition( *door_node, window_pos + ( window_pos - door_pos ) );
+    emit scene->nodeMoved( *door_node, scene->getNodePosition( *door_node ) );
+    QVERIFY( sameOfScene() );
+
+    // rebuilt after a removal
+    scene->removeNode( *window_node );
+    QCOMPARE( container->tree().nodesCount(), abs_tree.nodesCount() - 1 );
+    QVERIFY( sameOfScene() );
+}
+
 QTEST_MAIN(EditorTest)
 
 #include "editor_test.moc"
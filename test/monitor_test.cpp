@@ -0,0 +1,1014 @@
+#include "groot_test_base.h"
+#include "bt_editor/replay_log.h"
+#include "bt_editor/status_decoder.h"
+#include "bt_editor/monitor_history.h"
+#include "bt_editor/transition_heatmap.h"
+#ifdef ZMQ_FOUND
+#include "bt_editor/sidepanel_monitor.h"
+#include "bt_editor/monitor_publisher.h"
+#include "bt_editor/monitor_receiver.h"
+#include "bt_editor/headless_monitor.h"
+#include "bt_editor/shm_ring.h"
+#include "bt_editor/tree_sandbox.h"
+#include "bt_editor/log_writer.h"
+#include "bt_editor/monitor_protocol.h"
+#include "bt_editor/monitor_tree_cache.h"
+#include "bt_editor/XML_utilities.hpp"
+#include <QSpinBox>
+#include <QLineEdit>
+#include <QLabel>
+#include <QComboBox>
+#include <QTemporaryDir>
+#include <behaviortree_cpp_v3/bt_factory.h>
+#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+#endif
+#include <atomic>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <stdexcept>
+#include <cstring>
+#include <thread>
+
+// count the allocations of the whole process, to check the decoder
+namespace {
+std::atomic<size_t> allocations_count(0);
+
+template <typename T>
+void AppendScalar(QByteArray& buffer, T value)
+{
+    buffer.append( reinterpret_cast<const char*>(&value), sizeof(T) );
+}
+}
+
+void* operator new(std::size_t size)
+{
+    allocations_count++;
+    if( void* ptr = std::malloc( size > 0 ? size : 1 ) )
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free( ptr );
+}
+
+class MonitorTest : public GrootTestBase
+{
+    Q_OBJECT
+
+public:
+    MonitorTest() {}
+    ~MonitorTest() {}
+
+private slots:
+    void initTestCase();
+    void decodeMessage();
+    void decodeErrors();
+    void decodeWithoutAllocations();
+    void heatmapRate();
+    void monitorHistory();
+#ifdef ZMQ_FOUND
+    void monitorReplay();
+    void monitorThroughput();
+    void monitorReconnect();
+    void headlessMonitor();
+    void sharedMemoryRing();
+    void sharedMemoryConcurrent();
+    void monitorSharedMemory();
+    void blockedConnection();
+    void treeSandbox();
+    void treeSandboxScripts();
+    void statusHeaderMatches();
+    void logWriterRotation();
+    void treeCache();
+#endif
+
+private:
+    // a message of the publisher with the header of the whole tree and
+    // the transitions of crossdoor_trace.fbl
+    QByteArray createMessage();
+
+    QByteArray _log;
+    ReplayLog _replay;
+
+#ifdef ZMQ_FOUND
+    // "tcp://127.0.0.1:41234" -> "41234"
+    static std::string EndpointPort(const std::string& endpoint)
+    {
+        return endpoint.substr( endpoint.rfind(':') + 1 );
+    }
+
+    // a MonitorPublisher of the tree of crossdoor_trace.fbl. By default, the
+    // ports are chosen by the system: tests running in parallel don't collide
+    struct MonitorFixture
+    {
+        MonitorFixture(const std::string& tree_buffer,
+                       const std::string& address_pub = "tcp://127.0.0.1:*",
+                       const std::string& address_rep = "tcp://127.0.0.1:*"):
+            context(1),
+            publisher(context, address_pub, address_rep),
+            port_pub( EndpointPort( publisher.endpointPublisher() ) ),
+            port_rep( EndpointPort( publisher.endpointServer() ) )
+        {
+            publisher.setTree( tree_buffer );
+        }
+        zmq::context_t context;
+        MonitorPublisher publisher;
+        const std::string port_pub;
+        const std::string port_rep;
+    };
+
+    std::string treeBuffer() const;
+
+    const char* logTransitions() const;
+
+    // creates a MainWindow in monitor mode and connects it to the ports of a MonitorFixture
+    SidepanelMonitor* openMonitor(const std::string& port_pub, const std::string& port_rep,
+                                  bool shared_memory = false);
+
+    void closeMonitor();
+
+    // waits until the tree is requested and installed
+    bool waitTree(MonitorFixture& fixture, int timeout_ms);
+
+    // waits until the label of the sidepanel shows the expected count
+    bool waitMessages(uint64_t expected_count, int timeout_ms);
+#endif
+};
+
+void MonitorTest::initTestCase()
+{
+    _log = readFile("://crossdoor_trace.fbl");
+    _replay = ReadReplayLog( _log );
+}
+
+QByteArray MonitorTest::createMessage()
+{
+    const uint32_t tree_size = flatbuffers::ReadScalar<uint32_t>( _log.data() );
+    const int transitions_offset = 4 + tree_size;
+    const uint32_t num_transitions = (_log.size() - transitions_offset) / 12;
+
+    QByteArray msg;
+    AppendScalar( msg, uint32_t( 3 * _replay.uid_to_index.size() ) );
+    for (const auto& it: _replay.uid_to_index)
+    {
+        AppendScalar( msg, uint16_t(it.first) );
+        AppendScalar( msg, uint8_t(Serialization::NodeStatus::IDLE) );
+    }
+    AppendScalar( msg, num_transitions );
+    msg.append( _log.mid( transitions_offset, 12 * num_transitions ) );
+    return msg;
+}
+
+void MonitorTest::decodeMessage()
+{
+    StatusMessageDecoder decoder;
+    decoder.setTree( _replay.uid_to_index );
+
+    const QByteArray msg = createMessage();
+    std::vector<std::pair<int, NodeStatus>> state;
+    std::vector<MonitorRecord> transitions;
+
+    QCOMPARE( decoder.decode( msg.data(), msg.size(), state, transitions ), StatusMessageDecoder::OK );
+    QCOMPARE( state.size(), _replay.uid_to_index.size() );
+    QCOMPARE( transitions.size(), _replay.transitions.size() );
+
+    for (size_t i = 0; i < transitions.size(); i++)
+    {
+        const auto& expected = _replay.transitions[i];
+        QCOMPARE( int(transitions[i].index), int(expected.index) );
+        QCOMPARE( NodeStatus(transitions[i].status), expected.status );
+        QCOMPARE( NodeStatus(transitions[i].prev_status), expected.prev_status );
+    }
+}
+
+void MonitorTest::decodeErrors()
+{
+    StatusMessageDecoder decoder;
+    const QByteArray msg = createMessage();
+    std::vector<std::pair<int, NodeStatus>> state;
+    std::vector<MonitorRecord> transitions;
+
+    // no tree
+    QCOMPARE( decoder.decode( msg.data(), msg.size(), state, transitions ),
+              StatusMessageDecoder::UNKNOWN_UID );
+
+    decoder.setTree( _replay.uid_to_index );
+    QCOMPARE( decoder.decode( msg.data(), 4, state, transitions ),
+              StatusMessageDecoder::MALFORMED );
+    QCOMPARE( decoder.decode( msg.data(), msg.size() - 1, state, transitions ),
+              StatusMessageDecoder::MALFORMED );
+
+    // a UID which is not in the tree
+    auto partial_tree = _replay.uid_to_index;
+    partial_tree.erase( partial_tree.begin() );
+    decoder.setTree( partial_tree );
+    QCOMPARE( decoder.decode( msg.data(), msg.size(), state, transitions ),
+              StatusMessageDecoder::UNKNOWN_UID );
+}
+
+void MonitorTest::decodeWithoutAllocations()
+{
+    StatusMessageDecoder decoder;
+    decoder.setTree( _replay.uid_to_index );
+
+    const QByteArray msg = createMessage();
+    std::vector<std::pair<int, NodeStatus>> state;
+    std::vector<MonitorRecord> transitions;
+
+    // the first message reserves the buffers
+    QCOMPARE( decoder.decode( msg.data(), msg.size(), state, transitions ), StatusMessageDecoder::OK );
+
+    const int messages_count = 100000;
+    const size_t allocations_before = allocations_count;
+    QElapsedTimer timer;
+    timer.start();
+
+    bool all_ok = true;
+    for (int i = 0; i < messages_count; i++)
+    {
+        all_ok &= ( decoder.decode( msg.data(), msg.size(), state, transitions ) == StatusMessageDecoder::OK );
+    }
+    const qint64 elapsed_ns = timer.nsecsElapsed();
+    const size_t allocations = allocations_count - allocations_before;
+
+    QVERIFY( all_ok );
+    QCOMPARE( allocations, size_t(0) );
+    qDebug() << "decoding:" << double(elapsed_ns) / messages_count << "ns/message,"
+             << msg.size() << "bytes";
+}
+
+void MonitorTest::heatmapRate()
+{
+    TransitionHeatmap heatmap( 1.0 );
+    heatmap.reset( 3 );
+
+    // node 1 flaps at 1 kHz, node 2 changes once per second
+    for (int i = 0; i < 10000; i++)
+    {
+        const double time = i * 0.001;
+        heatmap.addTransition( 1, time );
+        if( i % 1000 == 0 )
+        {
+            heatmap.addTransition( 2, time );
+        }
+    }
+    const double now = 10.0;
+    QVERIFY( std::abs( heatmap.rate( 1, now ) - 1000 ) < 10 );
+    QVERIFY( heatmap.rate( 2, now ) > 0.3 && heatmap.rate( 2, now ) < 3 );
+    QCOMPARE( heatmap.rate( 0, now ), 0.0 );
+
+    // hot nodes are brighter, and everything cools down without transitions
+    QVERIFY( TransitionHeatmap::level( heatmap.rate( 1, now ) ) > 0.99 );
+    QVERIFY( TransitionHeatmap::level( heatmap.rate( 2, now ) ) < 0.5 );
+    QVERIFY( heatmap.rate( 1, now + 20 ) < TransitionHeatmap::MIN_RATE );
+    QCOMPARE( TransitionHeatmap::level( heatmap.rate( 1, now + 20 ) ), 0.0 );
+}
+
+void MonitorTest::monitorHistory()
+{
+    // 10 records, a keyframe every 4
+    MonitorHistory history( 10, 1000.0, 4 );
+    const std::vector<NodeStatus> initial( 5, NodeStatus::IDLE );
+    history.reset( initial );
+
+    const NodeStatus cycle[] = { NodeStatus::RUNNING, NodeStatus::SUCCESS,
+                                 NodeStatus::FAILURE, NodeStatus::IDLE };
+    std::vector<MonitorRecord> records;
+    std::vector<NodeStatus> current = initial;
+    for (uint32_t i = 0; i < 25; i++)
+    {
+        const uint16_t index = 1 + (i % 4);
+        const NodeStatus status = cycle[ (i / 4 + index) % 4 ];
+        MonitorRecord record = { i, 0, index, uint8_t(current[index]), uint8_t(status) };
+        current[index] = status;
+        records.push_back( record );
+        history.push( record );
+    }
+
+    // the ring wrapped: only the newest 10 records are left
+    QCOMPARE( history.size(), size_t(10) );
+    QCOMPARE( history.firstSequence(), uint64_t(15) );
+    QCOMPARE( history.endSequence(), uint64_t(25) );
+    for (uint64_t seq = 15; seq < 25; seq++)
+    {
+        QCOMPARE( history.at(seq).sec, records[seq].sec );
+    }
+    QVERIFY_EXCEPTION_THROWN( history.at(14), std::out_of_range );
+    QVERIFY_EXCEPTION_THROWN( history.at(25), std::out_of_range );
+
+    // the same status of a replay of every record from the beginning
+    auto expectedState = [&](uint64_t seq, std::vector<NodeStatus>& status,
+                             std::vector<NodeStatus>& prev_status)
+    {
+        status = initial;
+        prev_status.assign( initial.size(), NodeStatus::IDLE );
+        for (uint64_t s = 0; s < seq; s++)
+        {
+            prev_status[records[s].index] = NodeStatus(records[s].prev_status);
+            status[records[s].index] = NodeStatus(records[s].status);
+        }
+    };
+
+    std::vector<NodeStatus> status, prev_status, expected, expected_prev;
+    for (uint64_t seq: { uint64_t(15), uint64_t(20), uint64_t(22), uint64_t(25) })
+    {
+        history.stateAt( seq, status, prev_status );
+        expectedState( seq, expected, expected_prev );
+        QVERIFY( status == expected );
+        QVERIFY( prev_status == expected_prev );
+    }
+
+    // the evicted records were folded into the baseline
+    history.stateAt( 0, status, prev_status );
+    expectedState( 15, expected, expected_prev );
+    QVERIFY( status == expected );
+    QVERIFY( prev_status == expected_prev );
+
+    // the keyframe of 12 was evicted with its records
+    QCOMPARE( history.keyframeBefore( 15 ), uint64_t(15) );
+    QCOMPARE( history.keyframeBefore( 22 ), uint64_t(20) );
+    QCOMPARE( history.keyframeBefore( 25 ), uint64_t(24) );
+
+    history.reset( initial );
+    QVERIFY( history.empty() );
+    history.stateAt( 0, status, prev_status );
+    QVERIFY( status == initial );
+}
+
+#ifdef ZMQ_FOUND
+
+std::string MonitorTest::treeBuffer() const
+{
+    const uint32_t tree_size = flatbuffers::ReadScalar<uint32_t>( _log.data() );
+    return std::string( _log.data() + 4, tree_size );
+}
+
+const char* MonitorTest::logTransitions() const
+{
+    const uint32_t tree_size = flatbuffers::ReadScalar<uint32_t>( _log.data() );
+    return _log.data() + 4 + tree_size;
+}
+
+SidepanelMonitor* MonitorTest::openMonitor(const std::string& port_pub, const std::string& port_rep,
+                                           bool shared_memory)
+{
+    main_win = new MainWindow(GraphicMode::MONITOR, nullptr);
+    main_win->resize(1200, 800);
+    main_win->show();
+
+    auto sidepanel = main_win->findChild<SidepanelMonitor*>("SidepanelMonitor");
+    if( sidepanel )
+    {
+        main_win->findChild<QLineEdit*>("lineEdit")->setText("127.0.0.1");
+        main_win->findChild<QLineEdit*>("lineEdit_publisher")->setText( QString::fromStdString(port_pub) );
+        main_win->findChild<QLineEdit*>("lineEdit_server")->setText( QString::fromStdString(port_rep) );
+        main_win->findChild<QComboBox*>("comboTransport")->setCurrentIndex( shared_memory ? 1 : 0 );
+        sidepanel->on_Connect();
+    }
+    return sidepanel;
+}
+
+void MonitorTest::closeMonitor()
+{
+    auto sidepanel = main_win->findChild<SidepanelMonitor*>("SidepanelMonitor");
+    sidepanel->clear();
+    main_win->on_actionClear_triggered();
+    main_win->close();
+    delete main_win;
+    main_win = nullptr;
+}
+
+bool MonitorTest::waitTree(MonitorFixture& fixture, int timeout_ms)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while( fixture.publisher.requestsCount() == 0 && timer.elapsed() < timeout_ms )
+    {
+        sleepAndRefresh( 10 );
+    }
+    // give time to install the tree and to the SUB socket to complete the subscription
+    sleepAndRefresh( 200 );
+    return fixture.publisher.requestsCount() == 1;
+}
+
+bool MonitorTest::waitMessages(uint64_t expected_count, int timeout_ms)
+{
+    auto label = main_win->findChild<QLabel*>("labelCount");
+    const QString expected = QString("Messages received: %1").arg(expected_count);
+    QElapsedTimer timer;
+    timer.start();
+    while( timer.elapsed() < timeout_ms )
+    {
+        sleepAndRefresh( 5 );
+        if( label->text() == expected )
+        {
+            return true;
+        }
+    }
+    qDebug() << label->text() << "instead of" << expected;
+    return false;
+}
+
+void MonitorTest::monitorReplay()
+{
+    MonitorFixture fixture( treeBuffer() );
+    QVERIFY2( openMonitor( fixture.port_pub, fixture.port_rep ), "Can't get pointer to SidepanelMonitor" );
+    QVERIFY2( waitTree( fixture, 2000 ), "Can't get the tree from the MonitorPublisher" );
+
+    const auto tree = getAbstractTree();
+    QCOMPARE( tree.nodesCount(), _replay.tree.nodesCount() );
+
+    // one message per transition, as the real publisher might do
+    const char* transitions = logTransitions();
+    for (size_t t = 0; t < _replay.transitions.size(); t++)
+    {
+        fixture.publisher.publish( &transitions[12*t], 1 );
+    }
+    QVERIFY( waitMessages( _replay.transitions.size(), 5000 ) );
+
+    closeMonitor();
+}
+
+void MonitorTest::monitorThroughput()
+{
+    MonitorFixture fixture( treeBuffer() );
+    QVERIFY2( openMonitor( fixture.port_pub, fixture.port_rep ), "Can't get pointer to SidepanelMonitor" );
+    QVERIFY2( waitTree( fixture, 2000 ), "Can't get the tree from the MonitorPublisher" );
+
+    // all the transitions of the log in every message. The GUI thread is the one
+    // publishing: send bursts smaller than the high water mark of ZMQ and wait
+    // for the monitor to consume them, otherwise messages are dropped
+    const int messages_count = 20000;
+    const int burst = 500;
+    const char* transitions = logTransitions();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < messages_count; i += burst)
+    {
+        for (int b = 0; b < burst; b++)
+        {
+            fixture.publisher.publish( transitions, _replay.transitions.size() );
+        }
+        QVERIFY( waitMessages( i + burst, 5000 ) );
+    }
+
+    qDebug() << "monitor throughput:" << messages_count * 1000.0 / timer.elapsed() << "messages/s,"
+             << _replay.transitions.size() << "transitions each";
+
+    closeMonitor();
+}
+
+void MonitorTest::monitorReconnect()
+{
+    // two free ports, released right away: the robot binds them again later
+    std::string port_pub, port_rep;
+    {
+        MonitorFixture reserved( treeBuffer() );
+        port_pub = reserved.port_pub;
+        port_rep = reserved.port_rep;
+    }
+
+    // nobody is listening yet: connecting must not block the GUI
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY2( openMonitor( port_pub, port_rep ), "Can't get pointer to SidepanelMonitor" );
+    QVERIFY( timer.elapsed() < 1000 );
+    sleepAndRefresh( 1500 );
+
+    // the robot starts later; the delay between two attempts is at most 8 seconds
+    MonitorFixture fixture( treeBuffer(), "tcp://127.0.0.1:" + port_pub, "tcp://127.0.0.1:" + port_rep );
+    QVERIFY2( waitTree( fixture, 10000 ), "Can't get the tree from the MonitorPublisher" );
+
+    fixture.publisher.publish( logTransitions(), _replay.transitions.size() );
+    QVERIFY( waitMessages( 1, 2000 ) );
+
+    closeMonitor();
+}
+
+void MonitorTest::headlessMonitor()
+{
+    MonitorFixture fixture( treeBuffer() );
+    std::ostringstream summary;
+    HeadlessMonitor monitor( "tcp://127.0.0.1:" + fixture.port_pub, "tcp://127.0.0.1:" + fixture.port_rep,
+                             MonitorPolicy(), 0 );
+    monitor.start();
+    QVERIFY2( waitTree( fixture, 2000 ), "Can't get the tree from the MonitorPublisher" );
+
+    fixture.publisher.publish( logTransitions(), _replay.transitions.size() );
+
+    QElapsedTimer timer;
+    timer.start();
+    while( monitor.statistics().transitionsCount() < _replay.transitions.size() &&
+           timer.elapsed() < 2000 )
+    {
+        sleepAndRefresh( 10 );
+    }
+    QCOMPARE( monitor.statistics().transitionsCount(), uint64_t(_replay.transitions.size()) );
+
+    // same values of the statistics of the log (see replay_test)
+    uint64_t ticks = 0, success = 0, failure = 0;
+    for (const auto& node: monitor.statistics().nodes())
+    {
+        ticks   += node.ticks;
+        success += node.success_count;
+        failure += node.failure_count;
+    }
+    QCOMPARE( ticks, uint64_t(10) );
+    QCOMPARE( success, uint64_t(7) );
+    QCOMPARE( failure, uint64_t(3) );
+
+    monitor.printSummary( summary );
+    QVERIFY( summary.str().find("transitions: 27") != std::string::npos );
+}
+
+void MonitorTest::sharedMemoryRing()
+{
+    const std::string name = MonitorShmName("test_ring");
+    ShmStatusWriter writer( name, 4096 );
+    ShmStatusReader reader;
+    QVERIFY( reader.open( name ) );
+
+    // messages of different sizes, enough to wrap around the ring many times
+    std::string msg;
+    for (int i = 0; i < 1000; i++)
+    {
+        const std::string expected( 1 + (i * 37) % 300, char('a' + i % 26) );
+        QVERIFY( writer.write( expected.data(), expected.size() ) );
+        QVERIFY( reader.read( msg ) );
+        QCOMPARE( msg, expected );
+        QVERIFY( !reader.read( msg ) );
+    }
+    QCOMPARE( reader.overrunsCount(), uint64_t(0) );
+
+    // a reader that doesn't keep up is overrun, then starts again from the newest data
+    const std::string payload( 100, 'x' );
+    for (int i = 0; i < 100; i++)
+    {
+        writer.write( payload.data(), payload.size() );
+    }
+    QVERIFY( !reader.read( msg ) );
+    QCOMPARE( reader.overrunsCount(), uint64_t(1) );
+
+    writer.write( "last", 4 );
+    QVERIFY( reader.read( msg ) );
+    QCOMPARE( msg, std::string("last") );
+
+    // larger than the ring
+    const std::string huge( 8192, 'x' );
+    QVERIFY( !writer.write( huge.data(), huge.size() ) );
+}
+
+void MonitorTest::sharedMemoryConcurrent()
+{
+    const std::string name = MonitorShmName("test_concurrent");
+    ShmStatusWriter writer( name, 4096 );
+    ShmStatusReader reader;
+    QVERIFY( reader.open( name ) );
+
+    // the content of each message is a function of its sequence number:
+    // a message overwritten while it was read can't pass for a valid one
+    auto messageSize = [](uint32_t seq) -> size_t { return 4 + (seq * 37) % 1500; };
+    auto messageByte = [](uint32_t seq, size_t i) -> char { return char( (seq * 31 + i) & 0xFF ); };
+
+    const uint32_t messages_count = 200000;
+    std::atomic<bool> done(false);
+    std::thread writer_thread( [&]()
+    {
+        std::string msg;
+        for (uint32_t seq = 0; seq < messages_count; seq++)
+        {
+            msg.resize( messageSize(seq) );
+            std::memcpy( &msg[0], &seq, 4 );
+            for (size_t i = 4; i < msg.size(); i++)
+            {
+                msg[i] = messageByte( seq, i );
+            }
+            writer.write( msg.data(), msg.size() );
+        }
+        done = true;
+    });
+
+    std::string msg;
+    uint64_t received = 0;
+    uint64_t corrupted = 0;
+    int64_t prev_seq = -1;
+    while( true )
+    {
+        const bool writer_done = done;
+        if( !reader.read( msg ) )
+        {
+            if( writer_done && !reader.read( msg ) ) break;
+            continue;
+        }
+        received++;
+        uint32_t seq = 0;
+        bool valid = msg.size() >= 4;
+        if( valid )
+        {
+            std::memcpy( &seq, msg.data(), 4 );
+            valid = ( seq < messages_count && int64_t(seq) > prev_seq && msg.size() == messageSize(seq) );
+        }
+        for (size_t i = 4; valid && i < msg.size(); i++)
+        {
+            valid = ( msg[i] == messageByte( seq, i ) );
+        }
+        if( !valid )
+        {
+            corrupted++;
+            continue;
+        }
+        prev_seq = seq;
+    }
+    writer_thread.join();
+
+    qDebug() << "shared memory:" << received << "messages received," << reader.overrunsCount() << "overruns";
+    QVERIFY( received > 0 );
+    QCOMPARE( corrupted, uint64_t(0) );
+    // every message lost is accounted as part of an overrun
+    QVERIFY( received == messages_count || reader.overrunsCount() > 0 );
+}
+
+void MonitorTest::monitorSharedMemory()
+{
+    MonitorFixture fixture( treeBuffer() );
+    // same name used by the sidepanel for the publisher port
+    fixture.publisher.addSharedMemory( MonitorShmName( fixture.port_pub ) );
+
+    QVERIFY2( openMonitor( fixture.port_pub, fixture.port_rep, true ), "Can't get pointer to SidepanelMonitor" );
+    QVERIFY2( waitTree( fixture, 2000 ), "Can't get the tree from the MonitorPublisher" );
+
+    const char* transitions = logTransitions();
+    for (size_t t = 0; t < _replay.transitions.size(); t++)
+    {
+        fixture.publisher.publish( &transitions[12*t], 1 );
+    }
+    QVERIFY( waitMessages( _replay.transitions.size(), 5000 ) );
+
+    closeMonitor();
+}
+
+void MonitorTest::blockedConnection()
+{
+    const QByteArray msg = createMessage();
+    ShmStatusWriter writer_lossless( MonitorShmName("test_lossless"), 16*1024*1024 );
+    ShmStatusWriter writer_conflate( MonitorShmName("test_conflate"), 1024*1024 );
+
+    zmq::context_t context(1);
+    MonitorReceiver receiver( context );
+    receiver.addConnection( 1, MONITOR_SHM_SCHEME + MonitorShmName("test_lossless"),
+                            MonitorPolicy( MonitorPolicy::LOSSLESS ) );
+    receiver.addConnection( 2, MONITOR_SHM_SCHEME + MonitorShmName("test_conflate"),
+                            MonitorPolicy( MonitorPolicy::CONFLATE ) );
+    receiver.setTree( 1, _replay.uid_to_index );
+    receiver.setTree( 2, _replay.uid_to_index );
+
+    // a ring is read from the position of its writer when it is opened
+    auto waitOpen = [&](ShmStatusWriter& writer) -> bool
+    {
+        const uint64_t received = receiver.messagesCount();
+        for (int i = 0; i < 500 && receiver.messagesCount() == received; i++)
+        {
+            writer.write( msg.data(), msg.size() );
+            std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+        }
+        return receiver.messagesCount() > received;
+    };
+    QVERIFY( waitOpen( writer_lossless ) );
+    QVERIFY( waitOpen( writer_conflate ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds(50) );
+
+    MonitorStatusBatch batch;
+    while( receiver.pop( batch ) ) {}
+
+    // more messages than the queue can hold: the GUI doesn't pop anything
+    const int lossless_count = 1500;
+    for (int i = 0; i < lossless_count; i++)
+    {
+        QVERIFY( writer_lossless.write( msg.data(), msg.size() ) );
+    }
+    QElapsedTimer timer;
+    timer.start();
+    while( receiver.queueDepth() < 1024 && timer.elapsed() < 5000 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+    }
+    QCOMPARE( receiver.queueDepth(), size_t(1024) );
+    // the next message is read, then its connection is blocked
+    std::this_thread::sleep_for( std::chrono::milliseconds(50) );
+
+    // the blocked connection doesn't stop the others from being received
+    const uint64_t received = receiver.messagesCount();
+    const uint64_t dropped = receiver.counters().dropped.load();
+    QVERIFY( writer_conflate.write( msg.data(), msg.size() ) );
+    timer.restart();
+    while( receiver.messagesCount() == received && timer.elapsed() < 5000 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+    }
+    QCOMPARE( receiver.messagesCount(), received + 1 );
+
+    // and none of its messages is lost
+    int popped = 0;
+    timer.restart();
+    while( popped < lossless_count && timer.elapsed() < 5000 )
+    {
+        if( receiver.pop( batch ) )
+        {
+            popped += ( batch.connection_id == 1 ) ? 1 : 0;
+        }
+        else{
+            std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+        }
+    }
+    QCOMPARE( popped, lossless_count );
+    // the message of the CONFLATE connection, that found the queue full
+    QCOMPARE( receiver.counters().dropped.load(), dropped + 1 );
+    receiver.stop();
+}
+
+void MonitorTest::treeSandbox()
+{
+    // the tree is instantiated with dummy actions and conditions, and monitored in-process
+    const QString xml_text = readFile("://crossdoor_with_subtree.xml");
+    QDomDocument document;
+    QVERIFY( document.setContent( xml_text ) );
+    const NodeModels models = ReadTreeNodesModel( document.documentElement() );
+
+    main_win = new MainWindow(GraphicMode::MONITOR, nullptr);
+    main_win->resize(1200, 800);
+    main_win->show();
+
+    auto sidepanel = main_win->findChild<SidepanelMonitor*>("SidepanelMonitor");
+    QVERIFY2( sidepanel, "Can't get pointer to SidepanelMonitor" );
+    sidepanel->setSandboxTree( xml_text, models );
+    main_win->findChild<QComboBox*>("comboTransport")->setCurrentIndex( 2 );
+    main_win->findChild<QSpinBox*>("spinSandboxRate")->setValue( 1000 );
+    sidepanel->on_Connect();
+
+    QVERIFY( sidepanel->sandbox() && sidepanel->sandbox()->isRunning() );
+
+    QElapsedTimer timer;
+    timer.start();
+    auto label = main_win->findChild<QLabel*>("labelCount");
+    while( label->text().endsWith(": 0") && timer.elapsed() < 5000 )
+    {
+        sleepAndRefresh( 10 );
+    }
+    QCOMPARE( sidepanel->sandbox()->publisher().requestsCount(), uint64_t(1) );
+    QVERIFY( sidepanel->sandbox()->ticksCount() > 0 );
+    QVERIFY( sidepanel->sandbox()->transitionsCount() > 0 );
+    QVERIFY( !label->text().endsWith(": 0") );
+
+    // both trees, the subtree expanded
+    auto tree = getAbstractTree();
+    QVERIFY( tree.nodesCount() >= 13 );
+
+    // disconnecting stops the sandbox
+    sidepanel->on_Connect();
+    QVERIFY( sidepanel->sandbox() == nullptr );
+
+    closeMonitor();
+}
+
+void MonitorTest::treeSandboxScripts()
+{
+    // Sequence of a scripted condition and action: the root alternates SUCCESS and FAILURE
+    const QString xml_text =
+            "<root main_tree_to_execute=\"MainTree\">"
+            "  <BehaviorTree ID=\"MainTree\">"
+            "    <Sequence>"
+            "      <Condition ID=\"IsReady\"/>"
+            "      <Action ID=\"Move\" goal=\"1;2\"/>"
+            "    </Sequence>"
+            "  </BehaviorTree>"
+            "</root>";
+    NodeModels models;
+    NodeModel condition;
+    condition.type = NodeType::CONDITION;
+    condition.registration_ID = "IsReady";
+    models.insert( { condition.registration_ID, MakeNodeModel(condition) } );
+    NodeModel action;
+    action.type = NodeType::ACTION;
+    action.registration_ID = "Move";
+    action.ports.insert( { "goal", PortModel() } );
+    models.insert( { action.registration_ID, MakeNodeModel(action) } );
+
+    SandboxOptions options;
+    options.tick_rate = 0;
+    options.scripts["IsReady"] = "S";
+    options.scripts["Move"] = "SF";
+
+    zmq::context_t context(1);
+    TreeSandbox sandbox( context, "inproc://sandbox_pub", "inproc://sandbox_rep" );
+    sandbox.start( xml_text, models, options );
+    QVERIFY( sandbox.isRunning() );
+
+    QElapsedTimer timer;
+    timer.start();
+    while( sandbox.ticksCount() < 100 && timer.elapsed() < 2000 )
+    {
+        QTest::qWait( 1 );
+    }
+    sandbox.stop();
+    QVERIFY( !sandbox.isRunning() );
+
+    // Sequence, IsReady and Move: IDLE->RUNNING->result->IDLE or a subset of it,
+    // at least the 3 transitions of the results in each tick
+    const uint64_t ticks = sandbox.ticksCount();
+    QVERIFY( ticks >= 100 );
+    QVERIFY( sandbox.transitionsCount() >= 3 * ticks );
+
+    // a tree with nodes unknown to the models can't be created
+    NodeModels no_models;
+    bool thrown = false;
+    try{
+        sandbox.start( xml_text, no_models, options );
+    }
+    catch( std::runtime_error& )
+    {
+        thrown = true;
+    }
+    QVERIFY( thrown );
+    QVERIFY( !sandbox.isRunning() );
+}
+
+void MonitorTest::statusHeaderMatches()
+{
+    const std::string tree_buffer = treeBuffer();
+    const auto uids = TreeNodesUID( Serialization::GetBehaviorTree( tree_buffer.data() ) );
+    QCOMPARE( uids.size(), _replay.tree.nodesCount() );
+
+    auto createHeader = [](const std::vector<uint16_t>& header_uids)
+    {
+        QByteArray msg;
+        AppendScalar( msg, uint32_t( 3 * header_uids.size() ) );
+        for (uint16_t uid: header_uids)
+        {
+            AppendScalar( msg, uid );
+            AppendScalar( msg, uint8_t(Serialization::NodeStatus::IDLE) );
+        }
+        AppendScalar( msg, uint32_t(0) );
+        return msg;
+    };
+    auto matches = [&](const std::vector<uint16_t>& header_uids)
+    {
+        const QByteArray msg = createHeader( header_uids );
+        return StatusHeaderMatches( msg.data(), 3 * header_uids.size(), uids );
+    };
+
+    QVERIFY( matches( uids ) );
+
+    // another tree with the same number of nodes
+    auto other_uids = uids;
+    other_uids.back() += 1000;
+    QVERIFY( !matches( other_uids ) );
+
+    other_uids = uids;
+    std::swap( other_uids.front(), other_uids.back() );
+    QVERIFY( !matches( other_uids ) );
+
+    other_uids = uids;
+    other_uids.pop_back();
+    QVERIFY( !matches( other_uids ) );
+}
+
+void MonitorTest::logWriterRotation()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const std::string filename_A = dir.filePath("A.fbl").toStdString();
+    const std::string filename_B = dir.filePath("B.fbl").toStdString();
+
+    const std::string tree_buffer = treeBuffer();
+    const size_t log_count = _replay.transitions.size();
+    QVERIFY( log_count > 0 );
+
+    // appends the transitions of the log, repeated, in batches of different sizes
+    auto appendTransitions = [&](LogWriter& writer, size_t count)
+    {
+        size_t appended = 0;
+        size_t batch = 1;
+        while( appended < count )
+        {
+            const size_t n = std::min( { batch, count - appended, log_count - (appended % log_count) } );
+            writer.append( logTransitions() + MONITOR_TRANSITION_SIZE * ( appended % log_count ),
+                           MONITOR_TRANSITION_SIZE * n );
+            appended += n;
+            batch = ( batch % 97 ) + 1;
+        }
+    };
+
+    // more than one chunk of 256 KB in the first file
+    const size_t count_A = ( 600 * 1024 ) / MONITOR_TRANSITION_SIZE;
+    const size_t count_B = 1000;
+    {
+        // a small queue, to make append() wait for the writer
+        LogWriter writer( 64*1024 );
+        writer.openFile( filename_A, tree_buffer );
+        appendTransitions( writer, count_A );
+        writer.openFile( filename_B, tree_buffer );
+        appendTransitions( writer, count_B );
+        writer.flush();
+        QVERIFY( !writer.hasFailed() );
+        QCOMPARE( writer.bytesWritten(),
+                  uint64_t( 2 * (4 + tree_buffer.size()) + MONITOR_TRANSITION_SIZE * (count_A + count_B) ) );
+    }
+
+    auto checkFile = [&](const std::string& filename, size_t count)
+    {
+        QFile file( QString::fromStdString(filename) );
+        QVERIFY( file.open(QIODevice::ReadOnly) );
+        const ReplayLog log = ReadReplayLog( file.readAll() );
+
+        QVERIFY( log.tree == _replay.tree );
+        QCOMPARE( log.transitions.size(), count );
+        for (size_t i = 0; i < count; i++)
+        {
+            const auto& expected = _replay.transitions[ i % log_count ];
+            const auto& transition = log.transitions[i];
+            QCOMPARE( transition.index, expected.index );
+            QCOMPARE( transition.timestamp, expected.timestamp );
+            QCOMPARE( transition.prev_status, expected.prev_status );
+            QCOMPARE( transition.status, expected.status );
+        }
+    };
+    checkFile( filename_A, count_A );
+    checkFile( filename_B, count_B );
+}
+
+void MonitorTest::treeCache()
+{
+    auto serialize = [](const char* xml_text)
+    {
+        BT::BehaviorTreeFactory factory;
+        auto tree = factory.createTreeFromText( xml_text );
+        flatbuffers::FlatBufferBuilder builder(1024);
+        BT::CreateFlatbuffersBehaviorTree( builder, tree );
+        return std::string( reinterpret_cast<const char*>( builder.GetBufferPointer() ),
+                            builder.GetSize() );
+    };
+    const char* xml_A = R"(
+<root main_tree_to_execute = "MainTree" >
+    <BehaviorTree ID="MainTree">
+        <Sequence name="root">
+            <AlwaysSuccess name="first"/>
+            <AlwaysFailure name="second"/>
+        </Sequence>
+    </BehaviorTree>
+</root>)";
+    // only an instance name is different (and the UIDs, as in any other tree)
+    const char* xml_B = R"(
+<root main_tree_to_execute = "MainTree" >
+    <BehaviorTree ID="MainTree">
+        <Sequence name="root">
+            <AlwaysSuccess name="first"/>
+            <AlwaysFailure name="other"/>
+        </Sequence>
+    </BehaviorTree>
+</root>)";
+
+    const std::string buffer_A = serialize( xml_A );
+    const std::string buffer_B = serialize( xml_B );
+    auto fb_A = Serialization::GetBehaviorTree( buffer_A.data() );
+    auto fb_B = Serialization::GetBehaviorTree( buffer_B.data() );
+    QVERIFY( SameTreeStructure( fb_A, fb_A ) );
+    QVERIFY( !SameTreeStructure( fb_A, fb_B ) );
+
+    MonitorTreeCache cache( 2 );
+    const uint64_t id_A = cache.get( buffer_A ).id;
+    QCOMPARE( cache.missesCount(), uint64_t(1) );
+    QCOMPARE( cache.get( buffer_A ).tree.nodesCount(), size_t(4) );
+
+    // a second request of the same tree: the server sends the same buffer again.
+    // Serializing xml_A again would not do: BT.CPP gives new UIDs to each tree
+    const std::string resent_A = buffer_A;
+    QCOMPARE( cache.get( resent_A ).id, id_A );
+    QCOMPARE( cache.hitsCount(), uint64_t(2) );
+    QCOMPARE( cache.missesCount(), uint64_t(1) );
+
+    // a different tree
+    const auto& entry_B = cache.get( buffer_B );
+    QVERIFY( entry_B.id != id_A );
+    QCOMPARE( entry_B.tree.node(3)->instance_name, QString("other") );
+    QCOMPARE( cache.missesCount(), uint64_t(2) );
+    QCOMPARE( cache.size(), size_t(2) );
+
+    // the crossdoor tree evicts the oldest one
+    cache.get( treeBuffer() );
+    QCOMPARE( cache.size(), size_t(2) );
+    QVERIFY( cache.get( buffer_A ).id != id_A );
+    QCOMPARE( cache.missesCount(), uint64_t(4) );
+}
+
+#endif
+
+QTEST_MAIN(MonitorTest)
+
+#include "monitor_test.moc"
@@ -1,6 +1,13 @@
 #include "groot_test_base.h"
 #include "bt_editor/sidepanel_replay.h"
+#include "bt_editor/replay_renderer.h"
+#include "bt_editor/node_statistics.h"
+#include "bt_editor/tick_histogram.h"
 #include <QAction>
+#include <QTemporaryDir>
+#include <QImage>
+#include <QTabWidget>
+#include <QTableView>
 
 class ReplyTest : public GrootTestBase
 {
@@ -14,6 +21,12 @@ private slots:
     void initTestCase();
     void cleanupTestCase();
     void basicLoad();
+    void tickSegmentation();
+    void multipleTicks();
+    void renderFrames();
+    void nodeStatistics();
+    void statusOverlay();
+    void offscreenStyles();
 };
 
 
@@ -43,6 +56,285 @@ void ReplyTest::basicLoad()
     QCOMPARE( sidepanel_replay->transitionsCount(), size_t(27) );
 }
 
+void ReplyTest::tickSegmentation()
+{
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+
+    QByteArray log = readFile("://crossdoor_trace.fbl");
+    sidepanel_replay->loadLog( log );
+
+    // the trace contains a single execution of the tree
+    const auto& ticks = sidepanel_replay->ticks();
+    QCOMPARE( ticks.size(), size_t(1) );
+    QCOMPARE( ticks.front().first_transition, size_t(0) );
+    QCOMPARE( ticks.front().last_transition, size_t(26) );
+    QCOMPARE( ticks.front().active_nodes.size(), size_t(10) );
+    QVERIFY( std::abs( ticks.front().duration - 4.002382 ) < 1e-3 );
+
+    const auto& stats = sidepanel_replay->tickStatistics();
+    QCOMPARE( stats.max, ticks.front().duration );
+    QCOMPARE( stats.p50, ticks.front().duration );
+    QCOMPARE( stats.p99, ticks.front().duration );
+}
+
+void ReplyTest::multipleTicks()
+{
+    // a synthetic log with the tree of crossdoor_trace.fbl and 100 ticks,
+    // whose durations are the permutation (37*k % 100) +1 ms of 1..100 ms
+    const QByteArray crossdoor = readFile("://crossdoor_trace.fbl");
+    const ReplayLog crossdoor_log = ReadReplayLog( crossdoor );
+    uint16_t root_uid = 0, child_uid = 0;
+    for (const auto& it: crossdoor_log.uid_to_index)
+    {
+        if( it.second == 1 ) root_uid  = it.first;
+        if( it.second == 2 ) child_uid = it.first;
+    }
+    const uint32_t tree_size = flatbuffers::ReadScalar<uint32_t>( crossdoor.data() );
+    QByteArray log = crossdoor.left( 4 + tree_size );
+
+    auto appendTransition = [&log](uint64_t time_us, uint16_t uid,
+                                   Serialization::NodeStatus prev_status,
+                                   Serialization::NodeStatus status)
+    {
+        const uint32_t sec  = 10 + time_us / 1000000;
+        const uint32_t usec = time_us % 1000000;
+        log.append( reinterpret_cast<const char*>(&sec), 4 );
+        log.append( reinterpret_cast<const char*>(&usec), 4 );
+        log.append( reinterpret_cast<const char*>(&uid), 2 );
+        log.append( static_cast<char>(prev_status) );
+        log.append( static_cast<char>(status) );
+    };
+    using Serialization::NodeStatus;
+    const int ticks_count = 100;
+    std::vector<double> durations;
+    for (int k = 0; k < ticks_count; k++)
+    {
+        const uint64_t start_us = k * 200000;
+        const uint64_t duration_us = ( (37*k) % 100 + 1 ) * 1000;
+        durations.push_back( duration_us * 0.000001 );
+        appendTransition( start_us, root_uid, NodeStatus::IDLE, NodeStatus::RUNNING );
+        appendTransition( start_us + duration_us/2, child_uid, NodeStatus::IDLE, NodeStatus::SUCCESS );
+        appendTransition( start_us + duration_us, root_uid, NodeStatus::RUNNING, NodeStatus::SUCCESS );
+        appendTransition( start_us + duration_us, child_uid, NodeStatus::SUCCESS, NodeStatus::IDLE );
+        appendTransition( start_us + duration_us, root_uid, NodeStatus::SUCCESS, NodeStatus::IDLE );
+    }
+
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+    sidepanel_replay->loadLog( log );
+    QCOMPARE( sidepanel_replay->transitionsCount(), size_t(5 * ticks_count) );
+
+    // each tick starts with the restart of the root
+    const auto& ticks = sidepanel_replay->ticks();
+    QCOMPARE( ticks.size(), size_t(ticks_count) );
+    for (int k = 0; k < ticks_count; k++)
+    {
+        QCOMPARE( ticks[k].first_transition, size_t(5*k) );
+        QCOMPARE( ticks[k].last_transition, size_t(5*k + 4) );
+        QVERIFY( ticks[k].active_nodes == std::vector<int>({1, 2}) );
+        QVERIFY( std::abs( ticks[k].duration - durations[k] ) < 1e-6 );
+    }
+
+    // nearest-rank percentiles
+    const auto& stats = sidepanel_replay->tickStatistics();
+    QVERIFY( std::abs( stats.p50 - 0.050 ) < 1e-6 );
+    QVERIFY( std::abs( stats.p99 - 0.099 ) < 1e-6 );
+    QVERIFY( std::abs( stats.max - 0.100 ) < 1e-6 );
+    QCOMPARE( stats.histogram.size(), size_t(20) );
+    int histogram_total = 0;
+    for (int count: stats.histogram)
+    {
+        histogram_total += count;
+    }
+    QCOMPARE( histogram_total, ticks_count );
+
+    auto tab_widget = sidepanel_replay->findChild<QTabWidget*>("tabWidget");
+    tab_widget->setCurrentWidget( sidepanel_replay->findChild<QWidget*>("tabTicks") );
+    sleepAndRefresh( 100 );
+
+    // the last bin of the histogram: the slowest tick, 100 ms, is tick 27
+    auto histogram = sidepanel_replay->findChild<TickHistogram*>("tickHistogram");
+    QTest::mouseClick( histogram, Qt::LeftButton, Qt::NoModifier,
+                       QPoint( histogram->width() - 6, histogram->height() - 6 ) );
+    QCOMPARE( sidepanel_replay->currentRow(), int(ticks[27].last_transition) );
+
+    // a row of the table, wherever it was sorted
+    auto table = sidepanel_replay->findChild<QTableView*>("tableViewTicks");
+    QModelIndex tick_cell;
+    for (int row = 0; row < table->model()->rowCount(); row++)
+    {
+        QModelIndex cell = table->model()->index( row, 0 );
+        if( cell.data( Qt::DisplayRole ).toInt() == 3 )
+        {
+            tick_cell = cell;
+        }
+    }
+    QVERIFY( tick_cell.isValid() );
+    table->scrollTo( tick_cell );
+    QTest::mouseClick( table->viewport(), Qt::LeftButton, Qt::NoModifier,
+                       table->visualRect( tick_cell ).center() );
+    QCOMPARE( sidepanel_replay->currentRow(), int(ticks[3].last_transition) );
+
+    tab_widget->setCurrentIndex( 0 );
+}
+
+void ReplyTest::renderFrames()
+{
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+
+    QByteArray log = readFile("://crossdoor_trace.fbl");
+    sidepanel_replay->loadLog( log );
+
+    QTemporaryDir output_dir;
+    QVERIFY( output_dir.isValid() );
+
+    ReplayRenderOptions options;
+    options.output_dir = output_dir.path();
+    options.fps = 2;
+
+    // the log lasts 4.002 seconds
+    int frames = RenderReplayFrames( *main_win->getTabByName("BehaviorTree")->scene(),
+                                     ReadReplayLog( log ).transitions, options );
+    QCOMPARE( frames, 9 );
+
+    QImage first_frame( QDir( output_dir.path() ).filePath("frame_000000.png") );
+    QVERIFY( !first_frame.isNull() );
+}
+
+void ReplyTest::statusOverlay()
+{
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+    sidepanel_replay->loadLog( readFile("://crossdoor_trace.fbl") );
+    sleepAndRefresh( 100 );
+
+    auto container = main_win->getTabByName("BehaviorTree");
+    auto tree = getAbstractTree("BehaviorTree");
+
+    // the cached index -> Node table is the same of BuildTreeFromScene
+    const auto& gui_nodes = container->nodesByIndex();
+    QCOMPARE( gui_nodes.size(), tree.nodesCount() );
+    for (size_t index = 0; index < tree.nodesCount(); index++)
+    {
+        QCOMPARE( gui_nodes[index], tree.node(index)->graphic_node );
+    }
+
+    auto overlay = container->statusOverlay();
+    QCOMPARE( overlay->size(), tree.nodesCount() );
+    main_win->resetTreeStyle( *container );
+    QCOMPARE( overlay->outlinesCount(), size_t(0) );
+
+    std::vector<std::pair<int, NodeStatus>> node_status;
+    for (size_t index = 1; index < tree.nodesCount(); index++)
+    {
+        node_status.push_back( { int(index), NodeStatus::FAILURE } );
+    }
+    main_win->onChangeNodesStatus( "BehaviorTree", node_status );
+    sleepAndRefresh( 100 );
+
+    // all of them reference the same entry of the palette
+    const auto& failure_style = getStyleFromStatus( NodeStatus::FAILURE, NodeStatus::IDLE );
+    QCOMPARE( overlay->outlinesCount(), tree.nodesCount() - 1 );
+    for (size_t index = 1; index < tree.nodesCount(); index++)
+    {
+        QCOMPARE( overlay->style(index), &failure_style );
+    }
+
+    // the nodes themselves are never restyled
+    const QColor default_color = QtNodes::NodeStyle().NormalBoundaryColor;
+    for (size_t index = 0; index < tree.nodesCount(); index++)
+    {
+        QCOMPARE( tree.node(index)->graphic_node->nodeDataModel()->nodeStyle().NormalBoundaryColor,
+                  default_color );
+    }
+
+    main_win->resetTreeStyle( *container );
+    QCOMPARE( overlay->outlinesCount(), size_t(0) );
+}
+
+void ReplyTest::offscreenStyles()
+{
+    auto sidepanel_replay = main_win->findChild<SidepanelReplay*>("SidepanelReplay");
+    QVERIFY2( sidepanel_replay, "Can't get pointer to SidepanelReplay" );
+    sidepanel_replay->loadLog( readFile("://crossdoor_trace.fbl") );
+    sleepAndRefresh( 100 );
+
+    auto container = main_win->getTabByName("BehaviorTree");
+    auto tree = getAbstractTree("BehaviorTree");
+
+    // zoom on the first node: most of the others are outside of the view
+    auto root = tree.node(1)->graphic_node;
+    container->view()->resetTransform();
+    container->view()->scale( 4, 4 );
+    container->view()->centerOn( &root->nodeGraphicsObject() );
+    sleepAndRefresh( 100 );
+
+    std::vector<std::pair<int, NodeStatus>> node_status;
+    for (size_t index = 1; index < tree.nodesCount(); index++)
+    {
+        node_status.push_back( { int(index), NodeStatus::FAILURE } );
+    }
+    main_win->onChangeNodesStatus( "BehaviorTree", node_status );
+
+    // every style is recorded, but only the visible outlines are repainted
+    auto overlay = container->statusOverlay();
+    const auto& failure_style = getStyleFromStatus( NodeStatus::FAILURE, NodeStatus::IDLE );
+    const size_t pending = overlay->pendingCount();
+    QVERIFY( pending > 0 );
+    QVERIFY( pending < tree.nodesCount() - 1 );
+    QCOMPARE( overlay->outlinesCount(), tree.nodesCount() - 1 );
+    QCOMPARE( overlay->style(1), &failure_style );
+
+    // the others are repainted when they become visible
+    container->zoomHomeView();
+    sleepAndRefresh( 100 );
+    QCOMPARE( overlay->pendingCount(), size_t(0) );
+    for (size_t index = 1; index < tree.nodesCount(); index++)
+    {
+        QCOMPARE( overlay->style(index), &failure_style );
+    }
+
+    main_win->resetTreeStyle( *container );
+    QCOMPARE( overlay->pendingCount(), size_t(0) );
+}
+
+void ReplyTest::nodeStatistics()
+{
+    QByteArray content = readFile("://crossdoor_trace.fbl");
+    ReplayLog log = ReadReplayLog( content );
+
+    NodeStatistics statistics;
+    statistics.reset( log.tree.nodesCount() );
+    for (const auto& trans: log.transitions)
+    {
+        statistics.addTransition( trans.index, trans.prev_status, trans.status, trans.timestamp );
+    }
+    QCOMPARE( statistics.transitionsCount(), uint64_t(27) );
+
+    uint64_t ticks = 0, success = 0, failure = 0, running = 0;
+    double longest_running = 0;
+    for (const auto& node: statistics.nodes())
+    {
+        ticks   += node.ticks;
+        success += node.success_count;
+        failure += node.failure_count;
+        running += node.running_durations.count();
+        longest_running = std::max( longest_running, node.longest_running );
+    }
+    QCOMPARE( ticks, uint64_t(10) );
+    QCOMPARE( success, uint64_t(7) );
+    QCOMPARE( failure, uint64_t(3) );
+    QCOMPARE( running, uint64_t(8) );
+    QVERIFY( std::abs( longest_running - 4.002382 ) < 1e-3 );
+
+    // the root is the only node RUNNING for the whole log
+    const auto& root = statistics.nodes().at(1);
+    QCOMPARE( root.failureRate(), 0.0 );
+    QCOMPARE( root.running_durations.percentile(0.5), root.running_durations.max() );
+}
+
 QTEST_MAIN(ReplyTest)
 
 #include "replay_test.moc"